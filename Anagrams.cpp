@@ -0,0 +1,133 @@
+#include "Anagrams.h"
+
+#include <algorithm>
+#include <thread>
+
+#include "WordHunt.h"
+
+Anagrams::Anagrams()
+    : dict(std::make_shared<Dictionary>()), min_length(0), max_length(~0u) {}
+
+Anagrams::Anagrams(std::shared_ptr<const Dictionary> dict)
+    : dict(dict), min_length(0), max_length(~0u) {}
+
+std::shared_ptr<const Dictionary> Anagrams::dictionary() const { return dict; }
+
+// search a different dictionary from now on
+void Anagrams::setDictionary(std::shared_ptr<const Dictionary> dict) {
+    this->dict = dict;
+}
+
+// word lengths to look for
+void Anagrams::setWordLengths(unsigned min_length, unsigned max_length) {
+    this->min_length = min_length;
+    this->max_length = max_length;
+}
+
+// a word below node needs its required letters and at least minRemaining
+// more tiles, within max_length, and its longest word must reach
+// min_length. Unless node is a word itself, some letter continuing it
+// must still be in the rack. minRemaining is ~0u below a node with no
+// word, so it is compared unsigned.
+template <class Node>
+bool Anagrams::canFinish(const Node* node, int depth) const {
+    int room = tiles_left;
+    if (max_length < (unsigned)depth + room) room = max_length - depth;
+    if (room < 0 || node->minRemaining() > (unsigned)room) return false;
+    if (depth + node->maxRemaining() < min_length) return false;
+    if (node->requiredLetters() & ~avail_letters) return false;
+    return node->isEndpoint() || (node->subtreeLetters() & avail_letters);
+}
+
+// try every letter left in the rack that some word below node continues
+// with, in alphabetical order, so words come out sorted.
+template <class Node>
+void Anagrams::search(const Node* node, std::string& word_so_far) {
+    out->nodes++;
+    if (node->isEndpoint() && word_so_far.length() >= min_length &&
+        word_so_far.length() <= max_length) {
+        out->words.push_back(word_so_far);
+        out->score += WordHunt::wordScore(word_so_far.length());
+    }
+    unsigned todo = avail_letters & node->subtreeLetters() & ((1u << 26) - 1);
+    while (todo) {
+        int b = __builtin_ctz(todo);
+        todo &= todo - 1;
+        const Node* child = node->getChild('a' + b);
+        if (!child) continue;
+        // take a tile with this letter
+        tiles_left--;
+        if (--letter_counts[b] == 0) avail_letters &= ~(1u << b);
+        if (canFinish(child, word_so_far.length() + 1)) {
+            word_so_far.push_back('a' + b);
+            search(child, word_so_far);
+            word_so_far.pop_back();
+        }
+        // and put it back
+        tiles_left++;
+        letter_counts[b]++;
+        avail_letters |= 1u << b;
+    }
+}
+
+// count the rack's letters, search from the root, then rank the words:
+// they come out alphabetically and points only depend on length.
+Anagrams::Result Anagrams::solve(const std::string& rack) {
+    Result result;
+    result.rack = rack;
+    out = &result;
+    for (int i = 0; i < 26; i++) letter_counts[i] = 0;
+    avail_letters = 0;
+    tiles_left = 0;
+    for (unsigned i = 0; i < rack.length(); i++) {
+        char c = rack[i];
+        if (c >= 'A' && c <= 'Z') c += 'a' - 'A';
+        if (c < 'a' || c > 'z') continue;
+        letter_counts[c - 'a']++;
+        avail_letters |= CTrie::letterBit(c);
+        tiles_left++;
+    }
+
+    std::string word_so_far;
+    const FlatTrie* flat = dict->flat();
+    if (flat) {
+        if (canFinish(flat->root(), 0)) search(flat->root(), word_so_far);
+    } else if (canFinish(&dict->trie(), 0)) {
+        search(&dict->trie(), word_so_far);
+    }
+    std::stable_sort(result.words.begin(), result.words.end(),
+                     [](const std::string& a, const std::string& b) {
+                         return a.length() > b.length();
+                     });
+    out = nullptr;
+    return result;
+}
+
+namespace {
+// one worker: every threads-th rack starting at first.
+void anagramsWorker(const Anagrams* proto,
+                    const std::vector<std::string>* racks, unsigned first,
+                    unsigned threads, std::vector<Anagrams::Result>* out) {
+    Anagrams solver(*proto);
+    for (unsigned long i = first; i < racks->size(); i += threads) {
+        (*out)[i] = solver.solve((*racks)[i]);
+    }
+}
+}  // namespace
+
+std::vector<Anagrams::Result> Anagrams::solveAll(
+    const std::vector<std::string>& racks, unsigned threads) const {
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+    if (threads > racks.size()) threads = std::max<size_t>(racks.size(), 1);
+    std::vector<Result> results(racks.size());
+    std::vector<std::thread> workers;
+    // racks are dealt out in turn, so long and short racks spread evenly
+    for (unsigned t = 1; t < threads; t++) {
+        workers.push_back(
+            std::thread(anagramsWorker, this, &racks, t, threads, &results));
+    }
+    anagramsWorker(this, &racks, 0, threads, &results);
+    for (unsigned t = 0; t < workers.size(); t++) workers[t].join();
+    return results;
+}
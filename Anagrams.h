@@ -0,0 +1,63 @@
+#ifndef __ANAGRAMS_H__
+#define __ANAGRAMS_H__
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Dictionary.h"
+
+// Solves the Anagrams game: every dictionary word that can be spelled from
+// a rack of letters, each tile used at most once and in any order. It
+// searches the same Dictionary as WordHunt, with the rack's letter counts
+// in place of the board's adjacency: a branch is only followed while the
+// rack still holds the letters every word below it needs
+// (CTrie::requiredLetters), enough tiles for the shortest of them, and
+// some letter that continues it.
+class Anagrams {
+   public:
+    // the words a rack makes, best first.
+    struct Result {
+        std::string rack;
+        std::vector<std::string> words;  // highest score, then alphabetical
+        unsigned score = 0;
+        unsigned long nodes = 0;  // trie nodes visited
+    };
+
+    Anagrams();
+    // solve against a shared dictionary, no words are copied.
+    explicit Anagrams(std::shared_ptr<const Dictionary> dict);
+
+    std::shared_ptr<const Dictionary> dictionary() const;
+    void setDictionary(std::shared_ptr<const Dictionary> dict);
+
+    // only find words of min_length to max_length letters.
+    void setWordLengths(unsigned min_length, unsigned max_length);
+
+    // find the words in a rack. Letters are matched case-insensitively,
+    // anything other than a-z is ignored.
+    Result solve(const std::string& rack);
+
+    // solve many racks on `threads` threads (0 = all cores), each with its
+    // own copy of this solver. Results are in the same order as racks.
+    std::vector<Result> solveAll(const std::vector<std::string>& racks,
+                                 unsigned threads) const;
+
+   private:
+    std::shared_ptr<const Dictionary> dict;
+    unsigned min_length, max_length;
+
+    // tiles left per letter and the mask (see CTrie::letterBit) of the
+    // letters with any left, during a solve.
+    int letter_counts[26];
+    unsigned avail_letters;
+    int tiles_left;
+    Result* out;
+
+    template <class Node>
+    void search(const Node* node, std::string& word_so_far);
+    template <class Node>
+    bool canFinish(const Node* node, int depth) const;
+};
+
+#endif
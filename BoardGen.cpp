@@ -0,0 +1,62 @@
+#include "BoardGen.h"
+
+#include <algorithm>
+
+namespace {
+// relative frequency of a-z in English text, per 1000 letters.
+const int english_weights[26] = {82, 15, 28, 43, 127, 22, 20, 61, 70,
+                                 2,  8,  40, 24, 67,  75, 19, 1,  60,
+                                 63, 91, 28, 10, 24,  2,  20, 1};
+
+// the 16 standard letter cubes, "qu" faces are played as 'q'.
+const char* const standard_dice[16] = {
+    "aaeegn", "abbjoo", "achops", "affkps", "aoottw", "cimotu",
+    "deilrx", "delrvy", "distty", "eeghnw", "eeinsu", "ehrtvw",
+    "eiosst", "elrtty", "himnqu", "hlnnrz"};
+}  // namespace
+
+BoardGenerator::BoardGenerator(Distribution dist, unsigned seed)
+    : dist(dist), rng(seed) {
+    if (dist == ENGLISH) {
+        for (int i = 0; i < 26; i++) pool.append(english_weights[i], 'a' + i);
+    } else if (dist == DICE) {
+        dice.assign(standard_dice, standard_dice + 16);
+        // boards that aren't 4x4 draw from all the cube faces together
+        for (int i = 0; i < 16; i++) pool += standard_dice[i];
+    } else {
+        for (int i = 0; i < 26; i++) pool.push_back('a' + i);
+    }
+}
+
+BoardGenerator::BoardGenerator(const std::string& pool, unsigned seed)
+    : dist(UNIFORM), pool(pool), rng(seed) {
+    if (this->pool.empty()) this->pool = "abcdefghijklmnopqrstuvwxyz";
+}
+
+BoardGenerator BoardGenerator::fromName(const std::string& name,
+                                        unsigned seed) {
+    if (name == "english") return BoardGenerator(ENGLISH, seed);
+    if (name == "dice") return BoardGenerator(DICE, seed);
+    if (name.compare(0, 5, "pool:") == 0) {
+        return BoardGenerator(name.substr(5), seed);
+    }
+    return BoardGenerator(UNIFORM, seed);
+}
+
+// roll the next board
+void BoardGenerator::next(std::string& board) {
+    board.resize(GAME_SIZE * GAME_SIZE);
+    if (dist == DICE && GAME_SIZE * GAME_SIZE == 16) {
+        // shuffle the cubes onto the grid, then roll each one
+        std::shuffle(dice.begin(), dice.end(), rng);
+        for (int i = 0; i < 16; i++) {
+            board[i] = dice[i][rng() % dice[i].length()];
+        }
+        return;
+    }
+    for (int i = 0; i < (int)board.length(); i++) {
+        board[i] = pool[rng() % pool.length()];
+    }
+}
+
+void BoardGenerator::seed(unsigned seed) { rng.seed(seed); }
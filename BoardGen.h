@@ -0,0 +1,41 @@
+#ifndef __BOARDGEN_H__
+#define __BOARDGEN_H__
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "WordHunt.h"
+
+// generates random GAME_SIZE x GAME_SIZE boards from a letter distribution.
+class BoardGenerator {
+   public:
+    enum Distribution {
+        UNIFORM,  // every letter equally likely
+        ENGLISH,  // letters weighted by their frequency in English text
+        DICE      // the 16 standard letter cubes, shuffled and rolled
+    };
+
+    explicit BoardGenerator(Distribution dist, unsigned seed = 1);
+
+    // draw every tile from a pool of letters, repeating a letter makes it
+    // more likely, e.g. "eeeetaoin".
+    explicit BoardGenerator(const std::string& pool, unsigned seed = 1);
+
+    // parse a distribution name ("uniform", "english", "dice") or
+    // "pool:<letters>". Unknown names fall back to uniform.
+    static BoardGenerator fromName(const std::string& name, unsigned seed = 1);
+
+    // fill board with the next random board.
+    void next(std::string& board);
+
+    void seed(unsigned seed);
+
+   private:
+    Distribution dist;
+    std::string pool;
+    std::mt19937 rng;
+    std::vector<std::string> dice;
+};
+
+#endif
@@ -0,0 +1,198 @@
+#include "BoardStats.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <thread>
+
+#include "Lockstep.h"
+
+using namespace std::chrono;
+
+Histogram::Histogram(unsigned long width, unsigned buckets)
+    : width(width), bins(buckets, 0), total(0), sum(0), largest(0) {}
+
+void Histogram::add(unsigned long value) {
+    unsigned long b = value / width;
+    if (b >= bins.size()) b = bins.size() - 1;
+    bins[b]++;
+    total++;
+    sum += value;
+    if (value > largest) largest = value;
+}
+
+void Histogram::merge(const Histogram& rhs) {
+    for (unsigned i = 0; i < bins.size() && i < rhs.bins.size(); i++) {
+        bins[i] += rhs.bins[i];
+    }
+    total += rhs.total;
+    sum += rhs.sum;
+    if (rhs.largest > largest) largest = rhs.largest;
+}
+
+unsigned long Histogram::count() const { return total; }
+
+double Histogram::mean() const { return total ? (double)sum / total : 0.0; }
+
+unsigned long Histogram::max() const { return largest; }
+
+unsigned long Histogram::percentile(double p) const {
+    unsigned long seen = 0;
+    for (unsigned i = 0; i < bins.size(); i++) {
+        seen += bins[i];
+        if (seen >= p * total) return (i + 1) * width;
+    }
+    return bins.size() * width;
+}
+
+// one line per non-empty bucket: "  [lo, hi) count"
+void Histogram::print(std::ostream& os, const std::string& name) const {
+    os << name << ": mean " << mean() << ", p50 < " << percentile(0.5)
+       << ", p99 < " << percentile(0.99) << ", max " << largest << "\n";
+    for (unsigned i = 0; i < bins.size(); i++) {
+        if (!bins[i]) continue;
+        os << "  [" << i * width << ", ";
+        if (i + 1 == bins.size()) {
+            os << "inf";
+        } else {
+            os << (i + 1) * width;
+        }
+        os << ") " << bins[i] << "\n";
+    }
+}
+
+BoardStats::BoardStats(unsigned top_n) : top_n(top_n), best(NUM_METRICS) {
+    hists.push_back(Histogram(25, 40));      // words
+    hists.push_back(Histogram(5000, 40));    // score
+    hists.push_back(Histogram(50, 40));      // solve time in microseconds
+}
+
+void BoardStats::add(const std::string& board, unsigned words, unsigned score,
+                     unsigned long time_us) {
+    unsigned long values[NUM_METRICS] = {words, score, time_us};
+    std::greater<std::pair<unsigned long, std::string>> cmp;
+    for (int m = 0; m < NUM_METRICS; m++) {
+        hists[m].add(values[m]);
+        if (!top_n) continue;
+        std::vector<std::pair<unsigned long, std::string>>& heap = best[m];
+        if (heap.size() < top_n) {
+            heap.push_back(std::make_pair(values[m], board));
+            std::push_heap(heap.begin(), heap.end(), cmp);
+        } else if (values[m] > heap.front().first) {
+            std::pop_heap(heap.begin(), heap.end(), cmp);
+            heap.back() = std::make_pair(values[m], board);
+            std::push_heap(heap.begin(), heap.end(), cmp);
+        }
+    }
+}
+
+void BoardStats::merge(const BoardStats& rhs) {
+    std::greater<std::pair<unsigned long, std::string>> cmp;
+    for (int m = 0; m < NUM_METRICS; m++) {
+        hists[m].merge(rhs.hists[m]);
+        for (unsigned i = 0; i < rhs.best[m].size(); i++) {
+            std::vector<std::pair<unsigned long, std::string>>& heap = best[m];
+            heap.push_back(rhs.best[m][i]);
+            std::push_heap(heap.begin(), heap.end(), cmp);
+            if (heap.size() > top_n) {
+                std::pop_heap(heap.begin(), heap.end(), cmp);
+                heap.pop_back();
+            }
+        }
+    }
+}
+
+unsigned long BoardStats::boards() const { return hists[WORDS].count(); }
+
+const Histogram& BoardStats::histogram(Metric m) const { return hists[m]; }
+
+std::vector<std::pair<unsigned long, std::string>> BoardStats::top(
+    Metric m) const {
+    std::vector<std::pair<unsigned long, std::string>> sorted = best[m];
+    std::sort(sorted.begin(), sorted.end(),
+              std::greater<std::pair<unsigned long, std::string>>());
+    return sorted;
+}
+
+void BoardStats::print(std::ostream& os) const {
+    const char* names[NUM_METRICS] = {"words", "score", "solve time (us)"};
+    os << "boards: " << boards() << "\n";
+    for (int m = 0; m < NUM_METRICS; m++) {
+        hists[m].print(os, names[m]);
+    }
+    for (int m = 0; m < NUM_METRICS; m++) {
+        if (best[m].empty()) continue;
+        os << "top boards by " << names[m] << ":\n";
+        std::vector<std::pair<unsigned long, std::string>> sorted =
+            top((Metric)m);
+        for (unsigned i = 0; i < sorted.size(); i++) {
+            os << "  " << sorted[i].second << " " << sorted[i].first << "\n";
+        }
+    }
+}
+
+namespace {
+// one worker: solve its share of the boards with a private solver.
+void statsWorker(const WordHunt* proto, const std::string* dist,
+                 unsigned long boards, unsigned seed,
+                 BoardStats* out) {
+    WordHunt wh(*proto);
+    wh.setKeepWords(false);
+    BoardGenerator gen = BoardGenerator::fromName(*dist, seed);
+    std::string board;
+    if (wh.getEngine() == WordHunt::LOCKSTEP) {
+        // solve LANES boards per trie walk, each is charged an equal share
+        LockstepSolver solver(wh.dictionary());
+        std::vector<WordHunt> group(LockstepSolver::LANES, wh);
+        std::vector<std::string> group_boards(LockstepSolver::LANES);
+        for (unsigned long i = 0; i < boards; i += LockstepSolver::LANES) {
+            int count = LockstepSolver::LANES;
+            if (boards - i < (unsigned long)count) count = boards - i;
+            auto start = steady_clock::now();
+            for (int b = 0; b < count; b++) {
+                gen.next(group_boards[b]);
+                group[b].setBoard(group_boards[b]);
+            }
+            solver.solveGroup(&group[0], count);
+            auto stop = steady_clock::now();
+            unsigned long share =
+                duration_cast<microseconds>(stop - start).count() / count;
+            for (int b = 0; b < count; b++) {
+                out->add(group_boards[b], group[b].numWords(),
+                         group[b].score(), share);
+            }
+        }
+        return;
+    }
+    for (unsigned long i = 0; i < boards; i++) {
+        gen.next(board);
+        auto start = steady_clock::now();
+        wh.setBoard(board);
+        wh.solve();
+        auto stop = steady_clock::now();
+        out->add(board, wh.numWords(), wh.score(),
+                 duration_cast<microseconds>(stop - start).count());
+    }
+}
+}  // namespace
+
+BoardStats runBoardStats(const WordHunt& solver, const std::string& dist,
+                         unsigned long boards, unsigned threads,
+                         unsigned top_n, unsigned seed) {
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+    std::vector<BoardStats> partial(threads, BoardStats(top_n));
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; t++) {
+        // split the boards evenly, the first threads take the remainder
+        unsigned long share = boards / threads + (t < boards % threads);
+        workers.push_back(std::thread(statsWorker, &solver, &dist, share,
+                                      seed + t, &partial[t]));
+    }
+    BoardStats total(top_n);
+    for (unsigned t = 0; t < threads; t++) {
+        workers[t].join();
+        total.merge(partial[t]);
+    }
+    return total;
+}
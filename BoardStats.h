@@ -0,0 +1,68 @@
+#ifndef __BOARDSTATS_H__
+#define __BOARDSTATS_H__
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "BoardGen.h"
+#include "WordHunt.h"
+
+// counts of values in fixed-width buckets, the last bucket also holds
+// everything past the end.
+class Histogram {
+   public:
+    Histogram(unsigned long width, unsigned buckets);
+
+    void add(unsigned long value);
+    void merge(const Histogram& rhs);
+
+    unsigned long count() const;
+    double mean() const;
+    unsigned long max() const;
+    // smallest bucket upper bound with at least fraction p of the values.
+    unsigned long percentile(double p) const;
+
+    void print(std::ostream& os, const std::string& name) const;
+
+   private:
+    unsigned long width;
+    std::vector<unsigned long> bins;
+    unsigned long total;
+    unsigned long sum;
+    unsigned long largest;
+};
+
+// aggregate results of solving many boards.
+class BoardStats {
+   public:
+    enum Metric { WORDS, SCORE, TIME_US, NUM_METRICS };
+
+    explicit BoardStats(unsigned top_n = 10);
+
+    // add one solved board.
+    void add(const std::string& board, unsigned words, unsigned score,
+             unsigned long time_us);
+    void merge(const BoardStats& rhs);
+
+    unsigned long boards() const;
+    const Histogram& histogram(Metric m) const;
+    // best boards for a metric, highest first.
+    std::vector<std::pair<unsigned long, std::string>> top(Metric m) const;
+
+    void print(std::ostream& os) const;
+
+   private:
+    unsigned top_n;
+    std::vector<Histogram> hists;
+    // min-heaps of (value, board) holding the top_n boards per metric.
+    std::vector<std::vector<std::pair<unsigned long, std::string>>> best;
+};
+
+// generate and solve `boards` boards on `threads` threads (0 = all cores),
+// each thread with its own copy of solver. No word strings are kept.
+BoardStats runBoardStats(const WordHunt& solver, const std::string& dist,
+                         unsigned long boards, unsigned threads,
+                         unsigned top_n, unsigned seed);
+
+#endif
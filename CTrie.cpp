@@ -1,117 +1,363 @@
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 #include <string>
 #include <sstream>
 #include <vector>
 #include <iterator>
+#include <utility>
 
 #include "CTrie.h"
 
 //default constructor
-CTrie::CTrie(): isEnd(false) {
+CTrie::CTrie(): lexiconMask(0), letterMask(0), requiredMask(~0u), minRemain(~0u), maxRemain(0), wordCount(0) {
 }
 
 //copy constructor
-CTrie::CTrie(const CTrie& rhs) {
-    *this = rhs; //note this is the overloaded assignment operator
+CTrie::CTrie(const CTrie& rhs): lexiconMask(0), letterMask(0), requiredMask(~0u), minRemain(~0u), maxRemain(0), wordCount(0) {
+    this->copy_trie(rhs);
+}
+
+//move constructor, takes rhs' children and leaves it empty
+CTrie::CTrie(CTrie&& rhs): lexiconMask(0), letterMask(0), requiredMask(~0u), minRemain(~0u), maxRemain(0), wordCount(0) {
+    this->swap(rhs);
 }
 
 //destructor
 CTrie::~CTrie() {
-    //Iterate through all children and delete them recursively
+    this->clear();
+}
+
+//delete all child nodes with an explicit stack, each node is emptied
+//before it is deleted so its destructor has nothing left to recurse into
+void CTrie::clear() {
+    std::vector<CTrie *> stack;
     for (std::map<char, CTrie *>::iterator i = this->child.begin(); i != child.end(); i++) {
-        delete i->second;
+        stack.push_back(i->second);
     }
     this->child.clear();
+    while (!stack.empty()) {
+        CTrie *node = stack.back();
+        stack.pop_back();
+        for (std::map<char, CTrie *>::iterator i = node->child.begin(); i != node->child.end(); i++) {
+            stack.push_back(i->second);
+        }
+        node->child.clear();
+        delete node;
+    }
+}
+
+//copy rhs' nodes below this (empty) node, level by level
+void CTrie::copy_trie(const CTrie& rhs) {
+    std::vector<std::pair<CTrie *, const CTrie *> > stack;
+    stack.push_back(std::make_pair(this, &rhs));
+    while (!stack.empty()) {
+        CTrie *dst = stack.back().first;
+        const CTrie *src = stack.back().second;
+        stack.pop_back();
+        //set endpoint and subtree summary
+        dst->lexiconMask = src->lexiconMask;
+        dst->letterMask = src->letterMask;
+        dst->requiredMask = src->requiredMask;
+        dst->minRemain = src->minRemain;
+        dst->maxRemain = src->maxRemain;
+        dst->wordCount = src->wordCount;
+        for (std::map<char, CTrie *>::const_iterator i = src->child.begin(); i != src->child.end(); i++) {
+            CTrie *node = new CTrie;
+            //keys arrive in order, so hint the insert at the end
+            dst->child.emplace_hint(dst->child.end(), i->first, node);
+            stack.push_back(std::make_pair(node, i->second));
+        }
+    }
+}
+
+//exchange the contents of two tries
+void CTrie::swap(CTrie& rhs) {
+    std::swap(this->child, rhs.child);
+    std::swap(this->lexiconMask, rhs.lexiconMask);
+    std::swap(this->letterMask, rhs.letterMask);
+    std::swap(this->requiredMask, rhs.requiredMask);
+    std::swap(this->minRemain, rhs.minRemain);
+    std::swap(this->maxRemain, rhs.maxRemain);
+    std::swap(this->wordCount, rhs.wordCount);
 }
 
 //assignment operator
 CTrie& CTrie::operator=(const CTrie &rhs) {
     if (this != &rhs) {
-        //use destructor to empty left-hand side
-        this->~CTrie();
-        //iterate through rhs' child nodes and copy
-        for (std::map<char, CTrie *>::const_iterator i = rhs.child.begin(); i != rhs.child.end(); i++) {
-            this->child[i->first] = new CTrie(*i->second);
-        }
-        //set endpoint
-        this->isEnd = rhs.isEnd;
+        //copy first, rhs may be one of our own subtries
+        CTrie temp(rhs);
+        this->swap(temp);
+    }
+    return *this;
+}
+
+//move assignment operator
+CTrie& CTrie::operator=(CTrie &&rhs) {
+    if (this != &rhs) {
+        //take rhs before dropping our nodes, rhs may be one of them
+        CTrie temp(std::move(rhs));
+        this->swap(temp);
     }
     return *this;
 }
 
 //addition/assignment operator (overload)
 CTrie& CTrie::operator+=(const std::string& word) {
+    //plain insertion goes into the default lexicon
+    return this->insert(word, 1u);
+}
+
+//insert a word as a member of the given lexicons
+CTrie& CTrie::insert(const std::string& word, unsigned lexicons) {
+    //no lexicon means no word, and the summaries must not count one
+    if (!lexicons) return *this;
+    //letters of each suffix of the word, suffix[i] covers word[i..]
+    std::vector<unsigned> suffix(word.length() + 1, 0);
+    for (unsigned i = word.length(); i > 0; i--) {
+        suffix[i - 1] = suffix[i] | letterBit(word[i - 1]);
+    }
+    //nodes along the word, to count it once it turns out to be new
+    std::vector<CTrie *> path(word.length() + 1);
     //CTrie object to store data
     CTrie *temp = this;
     //iterate through word
     for (unsigned i = 0; i < word.length(); i++) {
+        path[i] = temp;
+        //fold the rest of the word into this node's subtree summary
+        temp->letterMask |= suffix[i];
+        temp->requiredMask &= suffix[i];
+        if (word.length() - i < temp->minRemain) temp->minRemain = word.length() - i;
+        if (word.length() - i > temp->maxRemain) temp->maxRemain = word.length() - i;
         //add element to map if it doesn't exist
         if (!temp->hasChild(word[i])) {
             temp->child.emplace(word[i], new CTrie);
         }
         temp = temp->child[word[i]];
     }
-    //set endpoint
-    temp->isEnd = true;
+    path[word.length()] = temp;
+    if (!temp->lexiconMask && lexicons) {
+        for (unsigned i = 0; i < path.size(); i++) path[i]->wordCount++;
+    }
+    //set endpoint, keeping any lexicons the word is already in
+    temp->lexiconMask |= lexicons;
+    temp->requiredMask = 0;
+    temp->minRemain = 0;
+    return *this;
+}
+
+//subtraction/assignment operator (overload)
+CTrie& CTrie::operator-=(const std::string& word) {
+    this->remove(word, ~0u);
     return *this;
 }
 
+//remove a word from the given lexicons; once it is in none, walk back up
+//its path deleting the nodes left without any word below them and
+//refolding the summaries of the rest
+bool CTrie::remove(const std::string& word, unsigned lexicons) {
+    std::vector<CTrie *> path(1, this);
+    for (unsigned i = 0; i < word.length(); i++) {
+        std::map<char, CTrie *>::iterator next = path.back()->child.find(word[i]);
+        if (next == path.back()->child.end()) return false;
+        path.push_back(next->second);
+    }
+    CTrie *temp = path.back();
+    if (!(temp->lexiconMask & lexicons)) return false;
+    temp->lexiconMask &= ~lexicons;
+    //still in another lexicon, the summaries don't depend on which
+    if (temp->lexiconMask) return true;
+    for (unsigned i = 0; i < path.size(); i++) path[i]->wordCount--;
+    for (unsigned i = word.length(); i > 0; i--) {
+        CTrie *node = path[i];
+        if (node->child.empty() && !node->lexiconMask) {
+            path[i - 1]->child.erase(word[i - 1]);
+            delete node;
+        } else {
+            node->summarize();
+        }
+    }
+    this->summarize();
+    return true;
+}
+
+//recompute this node's subtree summary from its own endpoint and its
+//children's summaries, the same values insert folds in word by word
+void CTrie::summarize() {
+    bool end = this->lexiconMask != 0;
+    this->letterMask = 0;
+    this->requiredMask = end ? 0 : ~0u;
+    this->minRemain = end ? 0 : ~0u;
+    this->maxRemain = 0;
+    for (std::map<char, CTrie *>::const_iterator i = this->child.begin(); i != this->child.end(); i++) {
+        const CTrie *next = i->second;
+        unsigned bit = letterBit(i->first);
+        this->letterMask |= bit | next->letterMask;
+        this->requiredMask &= bit | next->requiredMask;
+        if (next->minRemain != ~0u && next->minRemain + 1 < this->minRemain) this->minRemain = next->minRemain + 1;
+        if (next->maxRemain + 1 > this->maxRemain) this->maxRemain = next->maxRemain + 1;
+    }
+}
+
 //carat operator (overload)
 bool CTrie::operator^(const std::string& word) const {
-    //base case: check if word is 0
-    if (word.length() == 0) {
-        return this->isEndpoint();
+    return this->lookup(word) != 0;
+}
+
+//find the lexicons a word belongs to
+unsigned CTrie::lookup(const std::string& word) const {
+    const CTrie *temp = this;
+    //walk down the word, stopping if a letter is missing
+    for (unsigned i = 0; i < word.length() && temp; i++) {
+        temp = temp->getChild(word[i]);
     }
-    //iterate through child nodes and recursively call operator
-    for (std::map<char, CTrie *>::const_iterator i = this->child.begin(); i != this->child.end(); i++) {
-        if (word[0] == i->first) {
-            return *(i->second)^word.substr(1); //recursive call
+    if (!temp) return 0;
+    return temp->lexiconMask;
+}
+
+//find the lexicons of many words, see findAll
+std::vector<unsigned> CTrie::lookupAll(const std::vector<std::string>& words) const {
+    std::vector<const CTrie *> nodes = this->findAll(words);
+    std::vector<unsigned> out(nodes.size(), 0);
+    for (unsigned i = 0; i < nodes.size(); i++) {
+        if (nodes[i]) out[i] = nodes[i]->lexiconMask;
+    }
+    return out;
+}
+
+//check many prefixes, see findAll
+std::vector<bool> CTrie::hasPrefixAll(const std::vector<std::string>& prefixes) const {
+    std::vector<const CTrie *> nodes = this->findAll(prefixes);
+    std::vector<bool> out(nodes.size());
+    for (unsigned i = 0; i < nodes.size(); i++) out[i] = nodes[i] != nullptr;
+    return out;
+}
+
+//node reached by each word (nullptr if it falls off the trie), walking the
+//words in sorted order; path[d] is the node for the first d characters of
+//the current word and is kept for as long as the next word shares them
+std::vector<const CTrie *> CTrie::findAll(const std::vector<std::string>& words) const {
+    std::vector<unsigned> order(words.size());
+    for (unsigned i = 0; i < order.size(); i++) order[i] = i;
+    std::sort(order.begin(), order.end(), [&words](unsigned a, unsigned b) { return words[a] < words[b]; });
+
+    std::vector<const CTrie *> nodes(words.size(), nullptr);
+    std::vector<const CTrie *> path(1, this);
+    const std::string *prev = nullptr;
+    for (unsigned k = 0; k < order.size(); k++) {
+        const std::string &word = words[order[k]];
+        if (prev) {
+            //drop the nodes past the prefix shared with the previous word
+            unsigned shared = 0;
+            while (shared < prev->length() && shared < word.length() && (*prev)[shared] == word[shared]) shared++;
+            if (path.size() > shared + 1) path.resize(shared + 1);
+        }
+        //extend down the rest of the word, stopping if a letter is missing
+        while (path.size() <= word.length() && path.back()) {
+            path.push_back(path.back()->getChild(word[path.size() - 1]));
         }
+        if (path.size() == word.length() + 1) nodes[order[k]] = path.back();
+        prev = &word;
     }
-    return false;
+    return nodes;
 }
 
 //equality operator (overload)
 bool CTrie::operator==(const CTrie& rhs) const {
-    //check for numChildren and endpoint
-    if (this->numChildren() != rhs.numChildren() || this->isEndpoint() != rhs.isEndpoint()) return false;
-    //Iterate through child nodes (this)
-    for (std::map<char, CTrie *>::const_iterator i = this->child.begin(); i != this->child.end(); i++) {
-        //iterator for child nodes (rhs)
-        std::map<char, CTrie *>::const_iterator j;
-        j = rhs.child.find(i->first);
-        //check for j having a child with character
-        if (j == rhs.child.end()) return false;
-        //recursive step for each node
-        if (!(*i->second == *j->second)) return false;
+    //compare node pairs with an explicit stack
+    std::vector<std::pair<const CTrie *, const CTrie *> > stack;
+    stack.push_back(std::make_pair(this, &rhs));
+    while (!stack.empty()) {
+        const CTrie *lhs_node = stack.back().first;
+        const CTrie *rhs_node = stack.back().second;
+        stack.pop_back();
+        //check for numChildren and endpoint
+        if (lhs_node->numChildren() != rhs_node->numChildren() || lhs_node->lexiconMask != rhs_node->lexiconMask) return false;
+        //both maps are sorted, so matching children line up
+        std::map<char, CTrie *>::const_iterator j = rhs_node->child.begin();
+        for (std::map<char, CTrie *>::const_iterator i = lhs_node->child.begin(); i != lhs_node->child.end(); i++, j++) {
+            if (i->first != j->first) return false;
+            stack.push_back(std::make_pair(i->second, j->second));
+        }
     }
     //else (no false conditions are reached)
     return true;
 }
 
 //output stream operator (overload)
-//helper function to take string in as a parameter
-void CTrie::output_trie(std::ostream &os, std::string updated_str) const {
-    //iterate through child nodes
-    std::string fullstr = updated_str;
-    for (std::map<char, CTrie *>:: const_iterator i = this->child.begin(); i != this->child.end(); i++) {
-        //add characters into string until endpoint
-        updated_str = fullstr;
-        updated_str.push_back(i->first);
+//helper function walking the trie in order with an explicit stack of
+//(node, next child) frames, the current word grows and shrinks with it
+void CTrie::output_trie(std::ostream &os) const {
+    std::string word;
+    std::vector<std::pair<const CTrie *, std::map<char, CTrie *>::const_iterator> > stack;
+    stack.push_back(std::make_pair(this, this->child.begin()));
+    while (!stack.empty()) {
+        const CTrie *node = stack.back().first;
+        std::map<char, CTrie *>::const_iterator &i = stack.back().second;
+        if (i == node->child.end()) {
+            //done with this node, drop its character
+            stack.pop_back();
+            if (!stack.empty()) word.pop_back();
+            continue;
+        }
+        const CTrie *next = i->second;
+        word.push_back(i->first);
+        i++;
         //add line to output stream
-        if (i->second->isEndpoint()) os << updated_str << std::endl;
-        //recursive step
-        i->second->output_trie(os, updated_str);
+        if (next->isEndpoint()) os << word << '\n';
+        stack.push_back(std::make_pair(next, next->child.begin()));
     }
 }
 
+//the same walk as output_trie, collecting the endpoints
+std::vector<std::pair<std::string, unsigned> > CTrie::wordList() const {
+    std::vector<std::pair<std::string, unsigned> > out;
+    std::string word;
+    std::vector<std::pair<const CTrie *, std::map<char, CTrie *>::const_iterator> > stack;
+    stack.push_back(std::make_pair(this, this->child.begin()));
+    while (!stack.empty()) {
+        const CTrie *node = stack.back().first;
+        std::map<char, CTrie *>::const_iterator &i = stack.back().second;
+        if (i == node->child.end()) {
+            stack.pop_back();
+            if (!stack.empty()) word.pop_back();
+            continue;
+        }
+        const CTrie *next = i->second;
+        word.push_back(i->first);
+        i++;
+        if (next->isEndpoint()) out.push_back(std::make_pair(word, next->lexicons()));
+        stack.push_back(std::make_pair(next, next->child.begin()));
+    }
+    return out;
+}
+
 std::ostream& operator<<(std::ostream& os, const CTrie& ct) {
     //simple call, from hint in google docs
-    ct.output_trie(os, "");
+    ct.output_trie(os);
     return os;
 }
 
+//summarize size and shape, walking the trie with an explicit stack
+TrieShape CTrie::shape() const {
+    TrieShape ts;
+    std::vector<std::pair<const CTrie *, unsigned long> > stack;
+    stack.push_back(std::make_pair(this, 0ul));
+    while (!stack.empty()) {
+        const CTrie *node = stack.back().first;
+        unsigned long level = stack.back().second;
+        stack.pop_back();
+        ts.addNode(node->child.size(), level, node->isEndpoint());
+        //the root may live anywhere, every other node is heap allocated
+        ts.bytes += level ? TrieShape::heapBytes(sizeof(CTrie)) : sizeof(CTrie);
+        ts.bytes += node->child.size() * TrieShape::mapEntryBytes(sizeof(std::pair<const char, CTrie *>));
+        for (std::map<char, CTrie *>::const_iterator i = node->child.begin(); i != node->child.end(); i++) {
+            stack.push_back(std::make_pair(i->second, level + 1));
+        }
+    }
+    return ts;
+}
+
 //return the number of children
 unsigned CTrie::numChildren() const {
     return this->child.size();
@@ -144,5 +390,42 @@ const CTrie* CTrie::getChild(char character) const {
 
 //return true if this node is an endpoint, false otherwise
 bool CTrie::isEndpoint() const {
-    return this->isEnd;
+    return this->lexiconMask != 0;
+}
+
+//return bitmask of lexicons this endpoint belongs to
+unsigned CTrie::lexicons() const {
+    return this->lexiconMask;
+}
+
+//return bitmask of letters on links below this node
+unsigned CTrie::subtreeLetters() const {
+    return this->letterMask;
+}
+
+//return bitmask of letters shared by every word below this node
+unsigned CTrie::requiredLetters() const {
+    return this->requiredMask;
+}
+
+//return the length of the shortest word ending below this node
+unsigned CTrie::minRemaining() const {
+    return this->minRemain;
+}
+
+//return the length of the longest word ending below this node
+unsigned CTrie::maxRemaining() const {
+    return this->maxRemain;
+}
+
+//return the number of words ending at or below this node
+unsigned CTrie::subtreeWords() const {
+    return this->wordCount;
+}
+
+//map a character to its letter mask bit
+unsigned CTrie::letterBit(char character) {
+    if (character >= 'a' && character <= 'z') return 1u << (character - 'a');
+    //else
+    return 1u << 31;
 }
@@ -5,6 +5,8 @@
 #include <vector>
 #include <string>
 
+#include "TrieShape.h"
+
 class CTrie {
 public:
   /**
@@ -18,6 +20,12 @@ public:
    */
   CTrie(const CTrie& rhs);
 
+  /**
+   * Move Constructor.
+   * \param rhs The CTrie to take the nodes of, it is left empty.
+   */
+  CTrie(CTrie&& rhs);
+
   /**
    * Destructor.
    */
@@ -28,6 +36,11 @@ public:
    */
   CTrie& operator=(const CTrie &rhs);
 
+  /**
+   * Move assignment operator, rhs is left empty.
+   */
+  CTrie& operator=(CTrie &&rhs);
+
   /**
    * Overloaded addition/assignment operator to input a new string into the Trie.
    * \param word is the word to input into the operator.
@@ -35,6 +48,35 @@ public:
    */
   CTrie& operator+=(const std::string& word);
 
+  /**
+   * Input a new string into the Trie as a member of one or more lexicons.
+   * The endpoint keeps the union of every lexicon the word was added to.
+   * \param word is the word to input.
+   * \param lexicons bitmask of lexicons (bit i = lexicon i) the word belongs
+   *        to; 0 inserts nothing
+   * \return a reference to the CTrie object
+   */
+  CTrie& insert(const std::string& word, unsigned lexicons);
+
+  /**
+   * Overloaded subtraction/assignment operator to remove a word from every
+   * lexicon, see remove.
+   * \param word is the word to remove.
+   * \return a reference to the CTrie object
+   */
+  CTrie& operator-=(const std::string& word);
+
+  /**
+   * Remove a word from one or more lexicons. Once it is in none, the nodes
+   * that led only to it are deleted and the subtree summaries along its
+   * path are recomputed, so the trie is the same as one built without it.
+   * Takes time in the word's length times the fan-out along it.
+   * \param word is the word to remove.
+   * \param lexicons bitmask of lexicons to remove the word from
+   * \return true if the word was in any of those lexicons
+   */
+  bool remove(const std::string& word, unsigned lexicons = ~0u);
+
   /**
    * Overloaded carat operator to check whether a given word exists in the object.
    * \param word the word to find.
@@ -42,11 +84,34 @@ public:
    */
   bool operator^(const std::string &word) const;
 
+  /**
+   * Find the lexicons a given word belongs to.
+   * \param word the word to find.
+   * \return bitmask of lexicons containing the word, 0 if it is not a member
+   */
+  unsigned lookup(const std::string &word) const;
+
+  /**
+   * Find the lexicons of many words in one pass: the words are visited in
+   * sorted order and each one starts from the deepest node it shares with
+   * the word before it, instead of from the root.
+   * \param words the words to find, in any order, duplicates allowed
+   * \return the lookup() result for each word, in the same order as words
+   */
+  std::vector<unsigned> lookupAll(const std::vector<std::string> &words) const;
+
+  /**
+   * Check many prefixes in one pass, see lookupAll.
+   * \param prefixes the prefixes to check
+   * \return for each prefix, in order, whether some word starts with it
+   */
+  std::vector<bool> hasPrefixAll(const std::vector<std::string> &prefixes) const;
+
   /**
    * Overloaded equality operator to check whether two Trie objects are equal.
    * \param rhs A const reference to the CTrie object to compare.
    * \return true if the other object represents exactly the same set of words,
-   *         false otherwise
+   *         with the same lexicon membership, false otherwise
    */
   bool operator==(const CTrie& rhs) const;
 
@@ -61,11 +126,25 @@ public:
   */
   friend std::ostream& operator<<(std::ostream& os, const CTrie& ct);
 
+  /**
+   * List the words operator<< prints, without going through text.
+   * \return every word with the bitmask of lexicons it belongs to, in
+   *         alphabetical order
+   */
+  std::vector<std::pair<std::string, unsigned> > wordList() const;
+
   /**
    * \return the number of children
    */
   unsigned numChildren() const;
 
+  /**
+   * Walk the trie and summarize its size and shape.
+   * \return node and endpoint counts, estimated heap bytes, and fan-out
+   *         and depth histograms
+   */
+  TrieShape shape() const;
+
   /**
    * \return true if there are any children, false otherwise
    */
@@ -92,10 +171,62 @@ public:
    */
   bool isEndpoint() const; 
 
+  /**
+   * \return bitmask of lexicons this endpoint belongs to, 0 if not an endpoint
+   */
+  unsigned lexicons() const;
+
+  /**
+   * \return bitmask (see letterBit) of every letter that appears on a link
+   *         anywhere below this node
+   */
+  unsigned subtreeLetters() const;
+
+  /**
+   * \return bitmask (see letterBit) of the letters that appear in every word
+   *         completed below this node, 0 if this node is an endpoint
+   */
+  unsigned requiredLetters() const;
+
+  /**
+   * \return the fewest letters that must still be added to reach an endpoint
+   *         from this node, 0 if this node is an endpoint
+   */
+  unsigned minRemaining() const;
+
+  /**
+   * \return the most letters that can still be added to reach an endpoint
+   *         from this node, 0 if no word continues past it
+   */
+  unsigned maxRemaining() const;
+
+  /**
+   * \return the number of words ending at this node or below it
+   */
+  unsigned subtreeWords() const;
+
+  /**
+   * Map a character to the bit used for it in the subtree letter masks.
+   * \param character a character
+   * \return bit (c - 'a') for lowercase letters, bit 31 for anything else
+   */
+  static unsigned letterBit(char character);
+
 private:
+    friend class RTrie;
     std::map<char, CTrie *> child;
-    bool isEnd;
-    void output_trie(std::ostream &os, std::string updated_str) const;
+    unsigned lexiconMask;
+    unsigned letterMask;
+    unsigned requiredMask;
+    unsigned minRemain;
+    unsigned maxRemain;
+    unsigned wordCount;
+    void clear();
+    void summarize();
+    std::vector<const CTrie *> findAll(const std::vector<std::string> &words) const;
+    void copy_trie(const CTrie& rhs);
+    void swap(CTrie& rhs);
+    void output_trie(std::ostream &os) const;
 };
 
 #endif // CTRIE_H
@@ -2,6 +2,11 @@
 #include <sstream>
 
 #include "CTrie.h"
+#include "Completer.h"
+#include "FlatTrie.h"
+#include "RTrie.h"
+#include "WordDelta.h"
+#include "WordSet.h"
 
 using std::cout;
 using std::endl;
@@ -163,6 +168,471 @@ struct CTrieTest {
     ss << q;
     ASSERT(ss.str() == "hell\nhello\nhelp\njoanna\njohns\njohnson\n");
   }
+
+  static void LexiconTest() {
+    CTrie q = CTrie();
+    q.insert("hello", 1u);
+    q.insert("help", 2u);
+    q.insert("hello", 4u);
+    q += "hell";
+
+    ASSERT(q.lookup("hello") == 5u);
+    ASSERT(q.lookup("help") == 2u);
+    ASSERT(q.lookup("hell") == 1u);
+    ASSERT(q.lookup("hel") == 0u);
+    ASSERT(q.lookup("jelly") == 0u);
+    ASSERT(q ^ "help");
+    ASSERT(!(q ^ "hel"));
+
+    CTrie p = CTrie();
+    p += "hello";
+    p += "help";
+    p += "hell";
+    ASSERT(!(p == q));
+    p.insert("hello", 4u);
+    p.insert("help", 2u);
+    ASSERT(!(p == q));
+    CTrie r(q);
+    ASSERT(r == q);
+    ASSERT(r.getChild('h')->getChild('e')->getChild('l')->getChild('p')->lexicons() == 2u);
+
+    // no lexicons, no word: nothing, summaries included, changes
+    unsigned required = q.requiredLetters(), shortest = q.minRemaining();
+    q.insert("he", 0u);
+    q.insert("zzz", 0u);
+    ASSERT(q == r && !q.hasChild('z') && q.lookup("he") == 0u);
+    ASSERT(q.requiredLetters() == required && q.minRemaining() == shortest);
+    RTrie rt(q);
+    rt.insert("zzz", 0u);
+    ASSERT(rt.numNodes() == RTrie(q).numNodes());
+  }
+
+  static void SubtreeSummaryTest() {
+    CTrie q = CTrie();
+    q += "help";
+    q += "hippo";
+    q += "hoop";
+
+    const CTrie *h = q.getChild('h');
+    ASSERT(h->minRemaining() == 3);
+    ASSERT(h->requiredLetters() == CTrie::letterBit('p'));
+    ASSERT(h->subtreeLetters() == (CTrie::letterBit('e') | CTrie::letterBit('l') |
+                                   CTrie::letterBit('o') | CTrie::letterBit('p') |
+                                   CTrie::letterBit('i')));
+
+    const CTrie *hel = h->getChild('e')->getChild('l');
+    ASSERT(hel->minRemaining() == 1);
+    ASSERT(hel->requiredLetters() == CTrie::letterBit('p'));
+    ASSERT(h->maxRemaining() == 4);
+    ASSERT(hel->maxRemaining() == 1);
+    q += "hel";
+    ASSERT(hel->minRemaining() == 0);
+    ASSERT(hel->requiredLetters() == 0);
+    ASSERT(h->minRemaining() == 2);
+    ASSERT(hel->maxRemaining() == 1);
+    ASSERT(hel->getChild('p')->maxRemaining() == 0);
+    ASSERT(CTrie::letterBit('-') == (1u << 31));
+
+    CTrie p(q);
+    ASSERT(p.getChild('h')->minRemaining() == 2);
+    ASSERT(p.getChild('h')->requiredLetters() == 0);
+    ASSERT(p.getChild('h')->maxRemaining() == 4);
+    ASSERT(p.subtreeWords() == 4);
+    ASSERT(p.getChild('h')->getChild('e')->subtreeWords() == 2);
+    p.insert("hel", 2u);
+    ASSERT(p.subtreeWords() == 4);
+  }
+
+  static void RadixTest() {
+    CTrie q = CTrie();
+    q += "hello";
+    q += "hell";
+    q += "help";
+    q += "johns";
+    q.insert("joanna", 2u);
+    q += "johnson";
+
+    RTrie r(q);
+    std::stringstream ss1, ss2;
+    ss1 << q;
+    ss2 << r;
+    ASSERT(ss1.str() == ss2.str());
+
+    // root, "hel", "l", "lo", "p", "jo", "anna", "hns", "on"
+    ASSERT(r.numNodes() == 9);
+    ASSERT(r.getChild('j')->label() == "jo");
+    ASSERT(r.getChild('j')->getChild('h')->label() == "hns");
+    ASSERT(r.lookup("hell") == 1u);
+    ASSERT(r.lookup("joanna") == 2u);
+    ASSERT(r.lookup("joann") == 0u);
+    ASSERT(r.lookup("johnsons") == 0u);
+    ASSERT(r.lookup("") == 0u);
+
+    RTrie s(r);
+    ASSERT(s.lookup("johnson") == 1u);
+  }
+
+  // every link's label and lexicons, depth first
+  static std::string links(const RTrie& r) {
+    std::string out = "(" + r.label() + ":" + std::to_string(r.lexicons());
+    for (int c = 0; c < 128; c++) {
+      if (r.getChild(c)) out += links(*r.getChild(c));
+    }
+    return out + ")";
+  }
+
+  static void RadixEditTest() {
+    CTrie q = CTrie();
+    RTrie r(q);
+    // splits a label, extends one, adds a leaf, marks an inner node
+    const char* words[] = {"johnson", "johns", "joanna", "hello", "hell", "help", "he", "h"};
+    for (const char* w : words) {
+      q += w;
+      r.insert(w, 1u);
+    }
+    ASSERT(links(r) == links(RTrie(q)));
+    r.insert("joanna", 2u);
+    q.insert("joanna", 2u);
+    ASSERT(r.lookup("joanna") == 3u && links(r) == links(RTrie(q)));
+
+    // leaves go, and nodes left with one child and no word merge into it
+    const char* gone[] = {"help", "he", "johns", "hello", "joanna", "h"};
+    for (const char* w : gone) {
+      ASSERT(r.remove(w) && q.remove(w));
+      ASSERT(links(r) == links(RTrie(q)));
+    }
+    ASSERT(!r.remove("hel") && !r.remove("johnsons") && !r.remove("xyz"));
+    ASSERT(r.numNodes() == 3 && r.getChild('j')->label() == "johnson");
+    // only one lexicon of two
+    r.insert("hell", 2u);
+    ASSERT(r.remove("hell", 1u) && r.lookup("hell") == 2u && !r.remove("hell", 1u));
+  }
+
+  static void FlatTest() {
+    CTrie q = CTrie();
+    q += "hello";
+    q += "hell";
+    q += "help";
+    q.insert("joanna", 2u);
+    q += "jo-jo";
+
+    FlatTrie f(q, 3u);
+    // root, h, he, hel, hell, hello, help, j, jo, joa, joan, joann, joanna
+    ASSERT(f.numNodes() == 13);
+    ASSERT(f.lexicons() == 3u);
+    ASSERT(f.lookup("hell") == 1u);
+    ASSERT(f.lookup("joanna") == 2u);
+    ASSERT(f.lookup("jo-jo") == 0u);
+    ASSERT(f.lookup("hel") == 0u);
+    ASSERT(f.lookup("helps") == 0u);
+
+    const FlatNode *hel = f.root()->getChild('h')->getChild('e')->getChild('l');
+    ASSERT(hel->numChildren() == 2);
+    ASSERT(hel->hasChild('p'));
+    ASSERT(!hel->hasChild('x'));
+    ASSERT(hel->minRemaining() == 1);
+    ASSERT(hel->maxRemaining() == 2);
+    ASSERT(hel->getChild('l')->isEndpoint());
+    ASSERT(f.shape().nodes == 13);
+
+    // the dropped word is the only difference
+    CTrie r = CTrie();
+    r += "hello";
+    r += "hell";
+    r += "help";
+    r.insert("joanna", 2u);
+    ASSERT(f.toCTrie() == r);
+    FlatTrie view(f.root(), f.numNodes(), f.lexicons());
+    ASSERT(view.lookup("help") == 1u);
+
+    // every layout holds the same trie, subtree order puts the single
+    // child of a chain right after it
+    FlatTrie bfs(q, 3u, ~0u), sub(q, 3u, 0), huge(q, 3u, 1, true);
+    ASSERT(bfs.toCTrie() == r && sub.toCTrie() == r && huge.toCTrie() == r);
+    ASSERT(sub.numNodes() == 13 && sub.lookup("joanna") == 2u);
+    ASSERT(huge.hugePages() && huge.bfsLevels() == 1 && huge.lookup("hello") == 1u);
+    const FlatNode *joan = sub.root()->getChild('j')->getChild('o')->getChild('a')->getChild('n');
+    ASSERT(joan->getChild('n') == joan + 1);
+    const FlatNode *bjoan = bfs.root()->getChild('j')->getChild('o')->getChild('a')->getChild('n');
+    ASSERT(bjoan->getChild('n') != bjoan + 1);
+  }
+
+  static void BatchTest() {
+    CTrie q = CTrie();
+    q += "hello";
+    q += "hell";
+    q += "help";
+    q.insert("joanna", 2u);
+    q += "johns";
+
+    std::vector<std::string> words = {"help", "joanna", "he", "zebra", "hell",
+                                      "help", "", "hellos", "johns", "hello", "joh"};
+    std::vector<unsigned> found = q.lookupAll(words);
+    ASSERT(found.size() == words.size());
+    bool same = true;
+    for (unsigned i = 0; i < words.size(); i++) same = same && found[i] == q.lookup(words[i]);
+    ASSERT(same);
+    ASSERT(found[1] == 2u);
+    ASSERT(found[5] == 1u);
+
+    std::vector<bool> prefix = q.hasPrefixAll(words);
+    ASSERT(prefix[2] && prefix[6] && prefix[10]);
+    ASSERT(!prefix[3] && !prefix[7]);
+    ASSERT(q.lookupAll(std::vector<std::string>()).empty());
+  }
+
+  static void WordSetTest() {
+    WordSet w;
+    ASSERT(w.size() == 0);
+    ASSERT(!w.contains(""));
+    ASSERT(!w.contains("hello"));
+
+    // enough words to grow the table a few times
+    for (int i = 0; i < 1000; i++) {
+      std::stringstream ss;
+      ss << "word" << i;
+      w.insert(ss.str(), 1u);
+    }
+    w.insert("hello", 2u);
+    w.insert("hello", 4u);
+    w.insert("", 1u);
+    ASSERT(w.size() == 1002);
+    ASSERT(w.lookup("hello") == 6u);
+    ASSERT(w.contains("word0"));
+    ASSERT(w.contains("word999"));
+    ASSERT(!w.contains("word1000"));
+    ASSERT(!w.contains("hell"));
+    ASSERT(w.contains(""));
+    ASSERT(w.lookup("hello!", 5) == 6u);
+
+    WordSet c(w);
+    ASSERT(c.lookup("word500") == 1u);
+  }
+
+  static void CompleterTest() {
+    std::vector<std::pair<std::string, unsigned long> > counts({
+        {"car", 50}, {"card", 20}, {"care", 70}, {"careful", 5},
+        {"cart", 20}, {"cat", 90}, {"dog", 40}, {"car", 10}});
+    Completer c(counts, 2);
+    ASSERT(c.size() == 7);
+    ASSERT(c.count("car") == 60);
+    ASSERT(c.count("ca") == 0);
+    ASSERT(c.count("cars") == 0);
+
+    // cached lists, ties go to the alphabetically first word
+    ASSERT(c.complete("ca", 2) == std::vector<std::string>({"cat", "care"}));
+    ASSERT(c.complete("car", 1) == std::vector<std::string>({"care"}));
+    ASSERT(c.complete("card", 5) == std::vector<std::string>({"card"}));
+    ASSERT(c.complete("carefu", 2) == std::vector<std::string>({"careful"}));
+    ASSERT(c.complete("", 1) == std::vector<std::string>({"cat"}));
+    ASSERT(c.complete("x", 2).empty());
+    ASSERT(c.complete("cats", 2).empty());
+    // more than topK ranks the whole subtree
+    ASSERT(c.complete("car", 4) == std::vector<std::string>({"care", "car", "card", "cart"}));
+    ASSERT(c.complete("c", 10).size() == 6);
+    ASSERT(c.cacheBytes() > 0 && c.bytes() > c.cacheBytes());
+
+    std::stringstream ss("zebra 3\nzeal\n\nzero 7 extra\n");
+    std::vector<std::pair<std::string, unsigned long> > read = Completer::readCounts(ss);
+    ASSERT(read.size() == 3);
+    ASSERT(read[1].first == "zeal" && read[1].second == 1);
+    ASSERT(read[2].second == 7);
+    Completer z(read, 10);
+    ASSERT(z.complete("ze", 10) == std::vector<std::string>({"zero", "zebra", "zeal"}));
+  }
+
+  static void WordListTest() {
+    CTrie q = CTrie();
+    q += "help";
+    q += "hell";
+    q.insert("hello", 2u);
+    q.insert("hell", 4u);
+    q.insert("jo", 2u);
+    std::vector<std::pair<std::string, unsigned> > want({
+        {"hell", 5u}, {"hello", 2u}, {"help", 1u}, {"jo", 2u}});
+    ASSERT(q.wordList() == want);
+    ASSERT(CTrie().wordList().empty());
+    FlatTrie f(q, 7u);
+    ASSERT(f.wordList() == want);
+    ASSERT(f.toCTrie() == q);
+    f.remove("hello");
+    ASSERT(f.wordList().size() == 3 && f.wordList()[1].first == "help");
+  }
+
+  static void RemoveTest() {
+    CTrie q = CTrie();
+    q += "help";
+    q += "hippo";
+    q += "hoop";
+    q += "hel";
+    q.insert("hello", 2u);
+    q.insert("hoop", 2u);
+
+    ASSERT(!q.remove("he"));
+    ASSERT(!q.remove("helpless"));
+    ASSERT(!q.remove("help", 2u));
+    ASSERT(q.remove("hoop", 1u));
+    ASSERT(q.lookup("hoop") == 2u);
+    ASSERT(q.subtreeWords() == 5);
+
+    // the summaries are what a trie built without the word would have
+    q -= "hippo";
+    q -= "hel";
+    CTrie r = CTrie();
+    r += "help";
+    r.insert("hoop", 2u);
+    r.insert("hello", 2u);
+    ASSERT(q == r);
+    ASSERT(q.shape().nodes == r.shape().nodes);
+    const CTrie *h = q.getChild('h');
+    ASSERT(h->minRemaining() == 3);
+    ASSERT(h->maxRemaining() == 4);
+    ASSERT(h->subtreeWords() == 3);
+    ASSERT(h->subtreeLetters() == r.getChild('h')->subtreeLetters());
+    ASSERT(h->requiredLetters() == r.getChild('h')->requiredLetters());
+    ASSERT(!h->hasChild('i'));
+    q -= "hello";
+    q -= "help";
+    ASSERT(h->requiredLetters() == (CTrie::letterBit('o') | CTrie::letterBit('p')));
+    ASSERT(h->maxRemaining() == 3);
+    q -= "hoop";
+    ASSERT(q == CTrie() && !q.hasChild());
+    ASSERT(q.subtreeWords() == 0 && q.minRemaining() == ~0u);
+
+    // flattened nodes only drop the endpoint
+    CTrie s = CTrie();
+    s += "hell";
+    s += "help";
+    s.insert("hell", 2u);
+    FlatTrie f(s, 3u);
+    ASSERT(f.ownsNodes());
+    ASSERT(f.remove("hell", 1u) && f.lookup("hell") == 2u);
+    ASSERT(f.remove("help") && f.lookup("help") == 0u);
+    ASSERT(!f.remove("help") && !f.remove("he"));
+    ASSERT(f.numNodes() == 6 && f.toCTrie().subtreeWords() == 1);
+    FlatTrie view(f.root(), f.numNodes(), f.lexicons());
+    ASSERT(!view.ownsNodes() && !view.remove("hell"));
+
+    WordSet w;
+    w.insert("hell", 3u);
+    ASSERT(w.remove("hell", 1u) && w.lookup("hell") == 2u && w.size() == 1);
+    ASSERT(w.remove("hell", 2u) && !w.contains("hell") && w.size() == 0);
+    ASSERT(!w.remove("hell", 2u));
+    w.insert("hell", 1u);
+    ASSERT(w.size() == 1);
+  }
+
+  static void DeltaTest() {
+    std::stringstream before("cat dog\nemu\ncat\n"), after("ant cat\nemu eel\n");
+    WordDelta d = WordDelta::diff(before, after, 1);
+    ASSERT(d.size() == 3);
+    ASSERT(d.removals().size() == 1 && d.removals()[0].word == "dog");
+    ASSERT(d.additions()[0].word == "ant" && d.additions()[1].word == "eel");
+    std::stringstream text;
+    d.write(text);
+    ASSERT(text.str() == "-dog 1\n+ant 1\n+eel 1\n");
+
+    std::stringstream in("+yak\n# comment\n\n-cat 1\n+emu 1\nbogus\n+\n");
+    unsigned long malformed;
+    WordDelta e = WordDelta::read(in, &malformed);
+    ASSERT(e.size() == 3 && malformed == 2);
+    ASSERT(e.additions()[0].lexicon == 0 && e.removals()[0].word == "cat");
+
+    // a lexicon field out of range or not a number skips its line rather
+    // than landing in lexicon 0
+    std::stringstream bad("+foo 40\n-cat 40\n+bar x\n+baz 3x\n+qux -1\n+ok 31\n  -emu  \n");
+    WordDelta g = WordDelta::read(bad, &malformed);
+    ASSERT(malformed == 5 && g.size() == 2);
+    ASSERT(g.additions()[0].word == "ok" && g.additions()[0].lexicon == 31);
+    ASSERT(g.removals()[0].word == "emu" && g.removals()[0].lexicon == 0);
+
+    CTrie q = CTrie();
+    q.insert("cat", 2u);
+    q.insert("dog", 2u);
+    q.insert("emu", 2u);
+    ASSERT(d.applyTo(q) == 3);
+    ASSERT(q.lookup("dog") == 0u && q.lookup("ant") == 2u && q.lookup("eel") == 2u);
+    ASSERT(q.subtreeWords() == 4);
+    ASSERT(d.applyTo(q) == 0);
+
+    // a flattened trie takes removals only
+    FlatTrie f(q, 2u);
+    ASSERT(!d.applyTo(f) && f.lookup("dog") == 0u);
+    WordDelta gone;
+    gone.remove("cat", 0);
+    gone.remove("ant", 1);
+    ASSERT(gone.applyTo(f) && f.lookup("ant") == 0u && f.lookup("cat") == 2u);
+  }
+
+  static void ShapeTest() {
+    CTrie q = CTrie();
+    TrieShape empty = q.shape();
+    ASSERT(empty.nodes == 1);
+    ASSERT(empty.endpoints == 0);
+    ASSERT(empty.bytes == sizeof(CTrie));
+
+    q += "hell";
+    q += "hello";
+    q += "help";
+    TrieShape ts = q.shape();
+    // root, h, e, l, l, o, p
+    ASSERT(ts.nodes == 7);
+    ASSERT(ts.endpoints == 3);
+    ASSERT(ts.fanout.size() == 3);
+    ASSERT(ts.fanout[0] == 2 && ts.fanout[1] == 4 && ts.fanout[2] == 1);
+    ASSERT(ts.depth.size() == 6);
+    ASSERT(ts.depth[0] == 1 && ts.depth[4] == 2 && ts.depth[5] == 1);
+    ASSERT(ts.bytes > ts.nodes * sizeof(CTrie));
+
+    TrieShape rs = RTrie(q).shape();
+    // root, "hel", "l", "o", "p"
+    ASSERT(rs.nodes == 5);
+    ASSERT(rs.endpoints == 3);
+    ASSERT(rs.bytes < ts.bytes);
+  }
+
+  static void MoveTest() {
+    CTrie q = CTrie();
+    q += "hello";
+    q.insert("help", 2u);
+    CTrie copy(q);
+
+    CTrie p(std::move(q));
+    ASSERT(p == copy);
+    ASSERT(q.numChildren() == 0);
+    ASSERT(!(q ^ "hello"));
+
+    CTrie r = CTrie();
+    r += "rice";
+    r = std::move(p);
+    ASSERT(r == copy);
+    ASSERT(!(r ^ "rice"));
+    ASSERT(p.numChildren() == 0);
+
+    // assigning a subtrie of itself keeps the subtrie's words
+    r = *r.getChild('h');
+    ASSERT(r ^ "ello");
+    ASSERT(r.lookup("elp") == 2u);
+    ASSERT(!(r ^ "hello"));
+  }
+
+  static void LongWordTest() {
+    // deep enough to overflow the stack if any of these recursed per letter
+    std::string word(200000, 'a');
+    CTrie q = CTrie();
+    q += word;
+    q += word.substr(1);
+    CTrie p(q);
+    ASSERT(p == q);
+    ASSERT(p ^ word);
+    std::stringstream ss;
+    ss << p;
+    ASSERT(ss.str() == word.substr(1) + "\n" + word + "\n");
+    CTrie r = CTrie();
+    r = std::move(p);
+    ASSERT(r == q);
+    ASSERT(r.shape().nodes == word.length() + 1);
+  }
 };
 
 int main(int, char* argv[]) {
@@ -183,4 +653,18 @@ int main(int, char* argv[]) {
   CTrieTest::ChainingTest();
   CTrieTest::EqualityOperatorTest();
   CTrieTest::OutputStreamOperatorTest();
+  CTrieTest::LexiconTest();
+  CTrieTest::SubtreeSummaryTest();
+  CTrieTest::RadixTest();
+  CTrieTest::RadixEditTest();
+  CTrieTest::FlatTest();
+  CTrieTest::BatchTest();
+  CTrieTest::WordSetTest();
+  CTrieTest::CompleterTest();
+  CTrieTest::WordListTest();
+  CTrieTest::RemoveTest();
+  CTrieTest::DeltaTest();
+  CTrieTest::ShapeTest();
+  CTrieTest::MoveTest();
+  CTrieTest::LongWordTest();
 }
@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <sstream>
+
+#include "Completer.h"
+
+//sort and merge the words, build the trie level by level, then fill in
+//the cached lists from the deepest nodes up
+Completer::Completer(const std::vector<std::pair<std::string, unsigned long> >& words, unsigned topK): k(std::min(topK, 65535u)) {
+    std::vector<std::pair<std::string, unsigned long> > sorted(words);
+    std::sort(sorted.begin(), sorted.end());
+    for (unsigned long i = 0; i < sorted.size(); i++) {
+        if (i && sorted[i].first == sorted[i - 1].first) {
+            weight.back() += sorted[i].second;
+            continue;
+        }
+        start.push_back(pool.size());
+        pool += sorted[i].first;
+        weight.push_back(sorted[i].second);
+    }
+    start.push_back(pool.size());
+
+    //each node's words share its prefix, so they split into one run per
+    //next letter after the word (if any) that ends at the node
+    std::vector<unsigned> depth(1, 0);
+    Node root = {0, 0, (uint32_t)weight.size(), 0, 0, 0, 0};
+    nodes.push_back(root);
+    for (unsigned long i = 0; i < nodes.size(); i++) {
+        unsigned d = depth[i];
+        uint32_t j = nodes[i].lo, hi = nodes[i].hi;
+        if (j < hi && length(j) == d) j++;
+        nodes[i].firstChild = nodes.size();
+        while (j < hi) {
+            char c = pool[start[j] + d];
+            uint32_t e = j + 1;
+            while (e < hi && pool[start[e] + d] == c) e++;
+            Node child = {0, j, e, 0, 0, 0, c};
+            nodes.push_back(child);
+            depth.push_back(d + 1);
+            j = e;
+        }
+        nodes[i].children = nodes.size() - nodes[i].firstChild;
+    }
+
+    //children come after their parent, so walking backwards sees every
+    //child's list before the parent needs it
+    std::vector<uint32_t> candidates;
+    for (unsigned long i = nodes.size(); i-- > 0;) {
+        Node &n = nodes[i];
+        bool ends = n.lo < n.hi && length(n.lo) == depth[i];
+        if (n.children == 1 && !ends) {
+            n.first = nodes[n.firstChild].first;
+            n.count = nodes[n.firstChild].count;
+            continue;
+        }
+        candidates.clear();
+        if (ends) candidates.push_back(n.lo);
+        for (unsigned c = 0; c < n.children; c++) {
+            const Node &child = nodes[n.firstChild + c];
+            candidates.insert(candidates.end(), best.begin() + child.first, best.begin() + child.first + child.count);
+        }
+        unsigned keep = std::min<unsigned long>(k, candidates.size());
+        std::partial_sort(candidates.begin(), candidates.begin() + keep, candidates.end(),
+                          [this](uint32_t a, uint32_t b) { return before(a, b); });
+        n.first = best.size();
+        n.count = keep;
+        best.insert(best.end(), candidates.begin(), candidates.begin() + keep);
+    }
+    best.shrink_to_fit();
+    nodes.shrink_to_fit();
+}
+
+//the node reached by a prefix, children are sorted by letter
+const Completer::Node* Completer::find(const std::string& prefix) const {
+    const Node *n = &nodes[0];
+    for (unsigned i = 0; i < prefix.length(); i++) {
+        const Node *c = &nodes[n->firstChild], *end = c + n->children;
+        while (c != end && c->label != prefix[i]) c++;
+        if (c == end) return nullptr;
+        n = c;
+    }
+    return n;
+}
+
+//the cached list when it is long enough, otherwise rank the whole range
+std::vector<std::string> Completer::complete(const std::string& prefix, unsigned want) const {
+    std::vector<std::string> out;
+    const Node *n = find(prefix);
+    if (!n) return out;
+    if (want <= n->count || n->count == n->hi - n->lo) {
+        for (unsigned i = 0; i < want && i < n->count; i++) out.push_back(word(best[n->first + i]));
+        return out;
+    }
+    std::vector<uint32_t> ids;
+    for (uint32_t i = n->lo; i < n->hi; i++) ids.push_back(i);
+    unsigned keep = std::min<unsigned long>(want, ids.size());
+    std::partial_sort(ids.begin(), ids.begin() + keep, ids.end(),
+                      [this](uint32_t a, uint32_t b) { return before(a, b); });
+    for (unsigned i = 0; i < keep; i++) out.push_back(word(ids[i]));
+    return out;
+}
+
+//the word, if given, is the first one below its own node
+unsigned long Completer::count(const std::string& word) const {
+    const Node *n = find(word);
+    if (!n || n->lo == n->hi || length(n->lo) != word.length()) return 0;
+    return weight[n->lo];
+}
+
+//size of every array
+unsigned long Completer::bytes() const {
+    return nodes.capacity() * sizeof(Node) + start.capacity() * sizeof(uint32_t) + pool.capacity() +
+           weight.capacity() * sizeof(unsigned long) + cacheBytes();
+}
+
+//size of the cached lists
+unsigned long Completer::cacheBytes() const {
+    return best.capacity() * sizeof(uint32_t);
+}
+
+//"word [count]" lines
+std::vector<std::pair<std::string, unsigned long> > Completer::readCounts(std::istream& in) {
+    std::vector<std::pair<std::string, unsigned long> > out;
+    std::string line, word;
+    while (std::getline(in, line)) {
+        std::istringstream ss(line);
+        if (!(ss >> word)) continue;
+        unsigned long count;
+        if (!(ss >> count)) count = 1;
+        out.push_back(std::make_pair(word, count));
+    }
+    return out;
+}
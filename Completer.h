@@ -0,0 +1,107 @@
+#ifndef COMPLETER_H
+#define COMPLETER_H
+
+#include <stdint.h>
+#include <istream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Prefix completion ranked by word frequency. The words are kept sorted in
+ * one letter pool and indexed by a trie laid out breadth first, whose
+ * nodes each cover the range of words completed below them. Every node
+ * caches the ids of its topK most frequent completions, so completing a
+ * prefix walks the prefix and copies out at most topK words, without
+ * visiting the subtree. A node with a single child and no word of its own
+ * shares its child's list.
+ */
+class Completer {
+public:
+  /**
+   * Build the trie and the cached completions.
+   * \param words each word with its frequency, in any order; the
+   *        frequencies of repeated words are added up
+   * \param topK the number of completions cached per node, at most 65535
+   */
+  Completer(const std::vector<std::pair<std::string, unsigned long> > &words, unsigned topK);
+
+  /**
+   * Find the most frequent words starting with a prefix, the prefix itself
+   * included if it is a word. Ties go to the alphabetically first word.
+   * For k up to topK this takes time in the prefix length plus k; a larger
+   * k ranks every word below the prefix.
+   * \param prefix the letters typed so far
+   * \param k the number of completions wanted
+   * \return up to k words, most frequent first
+   */
+  std::vector<std::string> complete(const std::string &prefix, unsigned k) const;
+
+  /**
+   * \param word a word
+   * \return the word's frequency, 0 if it was not given
+   */
+  unsigned long count(const std::string &word) const;
+
+  /**
+   * \return the number of distinct words
+   */
+  unsigned long size() const { return weight.size(); }
+
+  /**
+   * \return the number of completions cached per node
+   */
+  unsigned topK() const { return k; }
+
+  /**
+   * \return bytes taken by the words, frequencies, nodes and cached lists
+   */
+  unsigned long bytes() const;
+
+  /**
+   * \return bytes taken by the cached lists alone, the cost of answering
+   *         without walking subtrees
+   */
+  unsigned long cacheBytes() const;
+
+  /**
+   * Read a frequency list: one word per line, optionally followed by
+   * whitespace and its count. A word without a count counts once.
+   * \param in the stream to read
+   * \return the words with their counts, in file order
+   */
+  static std::vector<std::pair<std::string, unsigned long> > readCounts(std::istream &in);
+
+private:
+  struct Node {
+    /** index of the first child, the children are stored together */
+    uint32_t firstChild;
+    /** the words completed below this node are ids lo to hi - 1 */
+    uint32_t lo, hi;
+    /** offset of this node's cached completions in best */
+    uint32_t first;
+    uint16_t children;
+    uint16_t count;
+    char label;
+  };
+
+  unsigned k;
+  std::vector<Node> nodes;
+  /** word ids, most frequent first, a run per node */
+  std::vector<uint32_t> best;
+  /** word i is pool[start[i]] to pool[start[i + 1]] */
+  std::vector<uint32_t> start;
+  std::string pool;
+  std::vector<unsigned long> weight;
+
+  /** the node reached by prefix, nullptr if no word starts with it */
+  const Node *find(const std::string &prefix) const;
+  unsigned length(uint32_t id) const { return start[id + 1] - start[id]; }
+  std::string word(uint32_t id) const { return pool.substr(start[id], length(id)); }
+  /** more frequent, or as frequent and alphabetically first */
+  bool before(uint32_t a, uint32_t b) const {
+    return weight[a] != weight[b] ? weight[a] > weight[b] : a < b;
+  }
+};
+
+#endif
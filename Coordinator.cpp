@@ -0,0 +1,308 @@
+#include "Coordinator.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdint.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+// write all of data, false if the other end is gone
+bool writeAll(int fd, const char* data, size_t length) {
+    while (length) {
+        ssize_t n = write(fd, data, length);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        length -= n;
+    }
+    return true;
+}
+
+// cpus in a /sys cpulist such as "0-3,8-11"
+std::vector<int> parseCpuList(const std::string& list) {
+    std::vector<int> cpus;
+    std::stringstream ss(list);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        int first = 0, last = 0;
+        int n = std::sscanf(range.c_str(), "%d-%d", &first, &last);
+        if (n < 1) continue;
+        if (n == 1) last = first;
+        for (int c = first; c <= last; c++) cpus.push_back(c);
+    }
+    return cpus;
+}
+
+// the cpus of each NUMA node, or one set of every online cpu without /sys
+std::vector<std::vector<int> > numaCpuSets() {
+    std::vector<std::vector<int> > sets;
+    for (int node = 0;; node++) {
+        std::ifstream file("/sys/devices/system/node/node" +
+                           std::to_string(node) + "/cpulist");
+        std::string list;
+        if (!std::getline(file, list)) break;
+        std::vector<int> cpus = parseCpuList(list);
+        if (!cpus.empty()) sets.push_back(cpus);
+    }
+    if (sets.empty()) {
+        std::vector<int> cpus;
+        for (long c = 0; c < sysconf(_SC_NPROCESSORS_ONLN); c++) {
+            cpus.push_back(c);
+        }
+        sets.push_back(cpus);
+    }
+    return sets;
+}
+}  // namespace
+
+Coordinator::Coordinator(const WordHunt& prototype,
+                         DictionaryStore::Builder build, const Options& opts)
+    : prototype(prototype), build(build), opts(opts) {
+    if (this->opts.workers == 0) this->opts.workers = 1;
+    if (this->opts.in_flight == 0) this->opts.in_flight = 1;
+    if (opts.pin) cpu_sets = numaCpuSets();
+}
+
+Coordinator::~Coordinator() {
+    // closing a worker's board pipe tells it to finish and exit
+    for (unsigned i = 0; i < workers.size(); i++) {
+        if (workers[i].to >= 0) close(workers[i].to);
+        if (workers[i].from >= 0) close(workers[i].from);
+    }
+    for (unsigned i = 0; i < workers.size(); i++) {
+        if (workers[i].pid > 0) waitpid(workers[i].pid, nullptr, 0);
+    }
+}
+
+// fork a worker into the slot
+void Coordinator::spawn(unsigned slot) {
+    int down[2], up[2];
+    if (pipe(down) != 0 || pipe(up) != 0) {
+        std::perror("pipe");
+        std::exit(1);
+    }
+    pid_t pid = fork();
+    if (pid < 0) {
+        std::perror("fork");
+        std::exit(1);
+    }
+    if (pid == 0) {
+        close(down[1]);
+        close(up[0]);
+        // other workers' pipes must only be open in the coordinator, or
+        // their ends never see EOF. Slots not spawned yet have none.
+        for (unsigned i = 0; i < workers.size(); i++) {
+            if (i == slot || workers[i].pid == 0) continue;
+            close(workers[i].to);
+            close(workers[i].from);
+        }
+        serve(slot, down[0], up[1]);
+        _exit(0);
+    }
+    close(down[0]);
+    close(up[1]);
+    Worker& w = workers[slot];
+    w.pid = pid;
+    w.to = down[1];
+    w.from = up[0];
+    w.in_flight.clear();
+    w.input.clear();
+}
+
+// a worker is gone: collect it and queue its unanswered boards again. The
+// oldest one is the board it was solving, only that one is blamed.
+void Coordinator::reap(unsigned slot) {
+    Worker& w = workers[slot];
+    close(w.to);
+    close(w.from);
+    kill(w.pid, SIGKILL);
+    waitpid(w.pid, nullptr, 0);
+    // the fd numbers may be handed out again before the slot is respawned
+    w.pid = 0;
+    w.to = w.from = -1;
+    for (unsigned k = w.in_flight.size(); k-- > 0;) {
+        unsigned long seq = w.in_flight[k];
+        if (k == 0 && ++boards[seq].second >= opts.max_attempts) {
+            std::cerr << "giving up on board " << boards[seq].first << std::endl;
+            boards.erase(seq);
+            failed.insert(seq);
+            stats.failed++;
+            continue;
+        }
+        pending.push_front(seq);
+    }
+    w.in_flight.clear();
+    stats.respawns++;
+}
+
+// the worker process: solve each board line and send back its results
+void Coordinator::serve(unsigned slot, int in, int out) {
+    if (!cpu_sets.empty()) {
+        const std::vector<int>& node = cpu_sets[slot % cpu_sets.size()];
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(node[(slot / cpu_sets.size()) % node.size()], &set);
+        sched_setaffinity(0, sizeof(set), &set);
+    }
+    WordHunt wh(prototype);
+    // built after pinning, so the pages are allocated on this node; if
+    // that fails the worker keeps the prototype's copy-on-write one
+    std::shared_ptr<const Dictionary> own = build ? build() : nullptr;
+    if (own) wh.setDictionary(own);
+
+    std::ostringstream buf;
+    ResultWriter writer(buf, opts.format);
+    writer.skipHeader();
+    FILE* boards_in = fdopen(in, "r");
+    char* line = nullptr;
+    size_t capacity = 0;
+    while (getline(&line, &capacity, boards_in) > 0) {
+        char* board_text = nullptr;
+        uint64_t seq = std::strtoull(line, &board_text, 10);
+        std::string board(board_text + 1, GAME_SIZE * GAME_SIZE);
+        wh.setBoard(board);
+        wh.solve();
+        writer.write(wh);
+        writer.flush();
+        std::string payload = buf.str();
+        buf.str("");
+
+        char header[12];
+        uint32_t length = payload.size();
+        std::memcpy(header, &seq, 8);
+        std::memcpy(header + 8, &length, 4);
+        if (!writeAll(out, header, 12) ||
+            !writeAll(out, payload.data(), payload.size())) {
+            break;
+        }
+    }
+    free(line);
+}
+
+// top the worker up to in_flight boards, false if it is gone
+bool Coordinator::dispatch(unsigned slot) {
+    Worker& w = workers[slot];
+    std::string lines;
+    while (w.in_flight.size() < opts.in_flight && !pending.empty()) {
+        unsigned long seq = pending.front();
+        pending.pop_front();
+        lines += std::to_string(seq) + " " + boards[seq].first + "\n";
+        w.in_flight.push_back(seq);
+    }
+    return lines.empty() || writeAll(w.to, lines.data(), lines.size());
+}
+
+// read what the worker has sent and file the complete results, false if
+// it is gone
+bool Coordinator::receive(unsigned slot) {
+    Worker& w = workers[slot];
+    char chunk[1 << 16];
+    ssize_t n = read(w.from, chunk, sizeof(chunk));
+    if (n < 0 && errno == EINTR) return true;
+    if (n <= 0) return false;
+    w.input.append(chunk, n);
+
+    size_t pos = 0;
+    while (w.input.size() - pos >= 12) {
+        uint64_t seq;
+        uint32_t length;
+        std::memcpy(&seq, w.input.data() + pos, 8);
+        std::memcpy(&length, w.input.data() + pos + 8, 4);
+        if (w.input.size() - pos - 12 < length) break;
+        ready[seq] = w.input.substr(pos + 12, length);
+        pos += 12 + length;
+        // answers come back in the order the boards were sent
+        w.in_flight.pop_front();
+        boards.erase(seq);
+        stats.per_worker[slot]++;
+    }
+    w.input.erase(0, pos);
+    return true;
+}
+
+Coordinator::Stats Coordinator::run(std::istream& in, std::ostream& out) {
+    auto start = std::chrono::steady_clock::now();
+    // a dead worker's pipe must fail the write, not kill the coordinator
+    signal(SIGPIPE, SIG_IGN);
+    workers.resize(opts.workers);
+    stats.per_worker.assign(opts.workers, 0);
+    for (unsigned i = 0; i < workers.size(); i++) spawn(i);
+
+    out << ResultWriter::header(opts.format);
+    unsigned long next_seq = 0, next_out = 0;
+    bool eof = false;
+    std::vector<pollfd> fds(workers.size());
+    while (true) {
+        // write out everything that is next in line
+        while (next_out < next_seq) {
+            std::map<unsigned long, std::string>::iterator it =
+                ready.find(next_out);
+            if (it != ready.end()) {
+                out << it->second;
+                ready.erase(it);
+                stats.boards++;
+            } else if (!failed.erase(next_out)) {
+                break;
+            }
+            next_out++;
+        }
+
+        // keep enough boards queued to fill every worker
+        while (!eof && pending.size() < workers.size() * opts.in_flight) {
+            std::string line;
+            if (!std::getline(in, line)) {
+                eof = true;
+                break;
+            }
+            if (line.length() != GAME_SIZE * GAME_SIZE) {
+                if (!line.empty()) std::cerr << "skipping " << line << std::endl;
+                continue;
+            }
+            boards[next_seq] = std::make_pair(line, 0u);
+            pending.push_back(next_seq++);
+        }
+        if (eof && boards.empty()) break;
+
+        for (unsigned i = 0; i < workers.size(); i++) {
+            if (!dispatch(i)) {
+                reap(i);
+                spawn(i);
+                dispatch(i);
+            }
+        }
+        for (unsigned i = 0; i < workers.size(); i++) {
+            fds[i].fd = workers[i].from;
+            fds[i].events = POLLIN;
+            fds[i].revents = 0;
+        }
+        if (poll(fds.data(), fds.size(), -1) < 0 && errno != EINTR) {
+            std::perror("poll");
+            break;
+        }
+        for (unsigned i = 0; i < workers.size(); i++) {
+            if (!fds[i].revents) continue;
+            if (!receive(i)) {
+                reap(i);
+                spawn(i);
+                dispatch(i);
+            }
+        }
+    }
+    out.flush();
+    stats.secs = std::chrono::duration_cast<std::chrono::microseconds>(
+                     std::chrono::steady_clock::now() - start)
+                     .count() /
+                 1e6;
+    return stats;
+}
@@ -0,0 +1,93 @@
+#ifndef __COORDINATOR_H__
+#define __COORDINATOR_H__
+
+#include <sys/types.h>
+
+#include <deque>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "DictionaryStore.h"
+#include "ResultWriter.h"
+#include "WordHunt.h"
+
+// Solves a stream of boards on several worker processes. Each worker is
+// forked from this process, optionally pinned to a core (spread over the
+// NUMA nodes listed in /sys) and then gets its own dictionary. Boards go
+// to workers over one pipe and results come back over another, both
+// bounded by `in_flight` boards per worker. Results are written in input
+// order whatever order the workers finish in.
+//
+// A worker that dies is replaced and its unanswered boards go to the next
+// free worker; a board that has taken down `max_attempts` workers is
+// dropped and counted as failed. Linux only (fork, pipes, poll,
+// sched_setaffinity).
+class Coordinator {
+   public:
+    struct Options {
+        unsigned workers = 2;
+        bool pin = false;          // pin each worker to a core
+        unsigned in_flight = 64;   // boards sent to a worker but unanswered
+        unsigned max_attempts = 3;
+        ResultWriter::Format format = ResultWriter::TEXT;
+    };
+
+    struct Stats {
+        unsigned long boards = 0;  // boards read and written out
+        unsigned long failed = 0;  // boards dropped after max_attempts
+        unsigned long respawns = 0;
+        double secs = 0;
+        std::vector<unsigned long> per_worker;  // boards solved per slot
+    };
+
+    // workers solve with prototype's settings (engine, lengths, budget,
+    // keep words). With a builder each worker builds its own dictionary
+    // after pinning, so its pages sit on its NUMA node; without one the
+    // workers share prototype's dictionary copy-on-write.
+    Coordinator(const WordHunt& prototype, DictionaryStore::Builder build,
+                const Options& opts);
+    // stops and reaps the workers.
+    ~Coordinator();
+
+    Coordinator(const Coordinator&) = delete;
+    Coordinator& operator=(const Coordinator&) = delete;
+
+    // solve every board read from in (one per line) and write the results
+    // to out. Call once, from a single-threaded process.
+    Stats run(std::istream& in, std::ostream& out);
+
+   private:
+    struct Worker {
+        // 0 and -1 until spawned and after reaped, so no stale fd is closed
+        pid_t pid = 0;
+        int to = -1;    // board lines, "seq board\n"
+        int from = -1;  // result frames, u64 seq, u32 length, payload
+        std::deque<unsigned long> in_flight;
+        std::string input;  // bytes read but not yet parsed
+    };
+
+    WordHunt prototype;
+    DictionaryStore::Builder build;
+    Options opts;
+    std::vector<Worker> workers;
+    std::vector<std::vector<int> > cpu_sets;
+
+    // boards not yet answered, by sequence number, with their attempts
+    std::map<unsigned long, std::pair<std::string, unsigned> > boards;
+    std::deque<unsigned long> pending;
+    std::set<unsigned long> failed;
+    std::map<unsigned long, std::string> ready;
+    Stats stats;
+
+    void spawn(unsigned slot);
+    void reap(unsigned slot);
+    void serve(unsigned slot, int in, int out);
+    bool dispatch(unsigned slot);
+    bool receive(unsigned slot);
+};
+
+#endif
@@ -0,0 +1,205 @@
+#include "Dictionary.h"
+
+#include <assert.h>
+
+#include <fstream>
+#include <unordered_map>
+
+Dictionary::Dictionary()
+    : loaded_lexicons(0), min_length(0), max_length(~0u), flat_trie(nullptr) {}
+
+Dictionary::Dictionary(const Dictionary& rhs)
+    : words(rhs.trie()),
+      loaded_lexicons(rhs.loaded_lexicons),
+      min_length(rhs.min_length),
+      max_length(rhs.max_length),
+      index(rhs.index ? new WordSet(*rhs.index) : nullptr),
+      completions(rhs.completions ? new Completer(*rhs.completions)
+                                  : nullptr),
+      flat_trie(nullptr) {
+    if (rhs.flat_copy) {
+        flatten(rhs.flat_copy->bfsLevels(), rhs.flat_copy->hugePages());
+    }
+}
+
+// load the file
+bool Dictionary::load_file(const std::string& filename, unsigned lexicon) {
+    assert(lexicon < 32);
+    if (flat_trie) return false;
+    std::ifstream file(filename);
+    if (!file) return false;
+
+    std::string word;
+    while (file >> word) {
+        if (word.length() < min_length || word.length() > max_length) continue;
+        words.insert(word, 1u << lexicon);
+        if (index) index->insert(word, 1u << lexicon);
+        // radix() won't build it again once it has been asked for
+        if (radix_trie) radix_trie->insert(word, 1u << lexicon);
+    }
+    loaded_lexicons |= 1u << lexicon;
+    completions.reset();
+    return true;
+}
+
+// removals, then additions, in every structure that holds the words
+unsigned long Dictionary::applyDelta(const WordDelta& delta) {
+    if (flat_trie && !flat_copy) {
+        words = flat_words ? std::move(*flat_words) : flat_trie->toCTrie();
+        flat_trie = nullptr;
+        flat_words.reset();
+    }
+    unsigned long changed = 0;
+    for (const WordDelta::Change& c : delta.removals()) {
+        if (!words.remove(c.word, 1u << c.lexicon)) continue;
+        changed++;
+        if (index) index->remove(c.word, 1u << c.lexicon);
+        if (flat_copy) flat_copy->remove(c.word, 1u << c.lexicon);
+        if (radix_trie) radix_trie->remove(c.word, 1u << c.lexicon);
+    }
+    bool grew = false;
+    for (const WordDelta::Change& c : delta.additions()) {
+        if (c.word.length() < min_length || c.word.length() > max_length) {
+            continue;
+        }
+        unsigned bit = 1u << c.lexicon;
+        loaded_lexicons |= bit;
+        if (words.lookup(c.word) & bit) continue;
+        words.insert(c.word, bit);
+        if (index) index->insert(c.word, bit);
+        if (radix_trie) radix_trie->insert(c.word, bit);
+        changed++;
+        grew = true;
+    }
+    // the flattened nodes have no room for new ones
+    if (grew && flat_copy) {
+        flatten(flat_copy->bfsLevels(), flat_copy->hugePages());
+    }
+    completions.reset();
+    return changed;
+}
+
+void Dictionary::setWordLengths(unsigned min_length, unsigned max_length) {
+    this->min_length = min_length;
+    this->max_length = max_length;
+}
+
+unsigned Dictionary::minLength() const { return min_length; }
+
+unsigned Dictionary::maxLength() const { return max_length; }
+
+// words loaded before the index existed get added to it here
+void Dictionary::setWordIndex(bool enable) {
+    if (!enable) {
+        index.reset();
+        return;
+    }
+    if (index) return;
+    index.reset(new WordSet);
+    std::vector<std::pair<std::string, unsigned> > all = wordList();
+    for (unsigned long i = 0; i < all.size(); i++) {
+        index->insert(all[i].first, all[i].second);
+    }
+}
+
+unsigned Dictionary::lookup(const std::string& word) const {
+    if (index) return index->lookup(word);
+    if (flat_trie) return flat_trie->lookup(word);
+    return words.lookup(word);
+}
+
+bool Dictionary::contains(const std::string& word) const {
+    return lookup(word) != 0;
+}
+
+std::vector<unsigned> Dictionary::lookupAll(
+    const std::vector<std::string>& words) const {
+    if (!index && (!flat_trie || flat_copy)) {
+        return this->words.lookupAll(words);
+    }
+    std::vector<unsigned> out(words.size());
+    for (unsigned i = 0; i < words.size(); i++) out[i] = lookup(words[i]);
+    return out;
+}
+
+const WordSet* Dictionary::wordIndex() const { return index.get(); }
+
+void Dictionary::setCompletions(
+    const std::vector<std::pair<std::string, unsigned long> >& counts,
+    unsigned top_k) {
+    completions = buildCompleter(counts, top_k);
+}
+
+// every dictionary word gets its count, or 0
+std::unique_ptr<Completer> Dictionary::buildCompleter(
+    const std::vector<std::pair<std::string, unsigned long> >& counts,
+    unsigned top_k) const {
+    std::unordered_map<std::string, unsigned long> given;
+    for (unsigned long i = 0; i < counts.size(); i++) {
+        given[counts[i].first] += counts[i].second;
+    }
+    std::vector<std::pair<std::string, unsigned> > all = wordList();
+    std::vector<std::pair<std::string, unsigned long> > weighted;
+    weighted.reserve(all.size());
+    for (unsigned long w = 0; w < all.size(); w++) {
+        std::unordered_map<std::string, unsigned long>::const_iterator i =
+            given.find(all[w].first);
+        weighted.push_back(
+            std::make_pair(all[w].first, i == given.end() ? 0 : i->second));
+    }
+    return std::unique_ptr<Completer>(new Completer(weighted, top_k));
+}
+
+std::vector<std::string> Dictionary::complete(const std::string& prefix,
+                                              unsigned k) const {
+    if (!completions) return std::vector<std::string>();
+    return completions->complete(prefix, k);
+}
+
+const Completer* Dictionary::completer() const { return completions.get(); }
+
+std::shared_ptr<const Dictionary> Dictionary::fromFile(
+    const std::string& filename) {
+    std::shared_ptr<Dictionary> dict = std::make_shared<Dictionary>();
+    if (!dict->load_file(filename)) return nullptr;
+    return dict;
+}
+
+std::shared_ptr<const Dictionary> Dictionary::fromFlat(const FlatTrie& flat) {
+    std::shared_ptr<Dictionary> dict = std::make_shared<Dictionary>();
+    dict->flat_trie = &flat;
+    dict->loaded_lexicons = flat.lexicons();
+    return dict;
+}
+
+// the words stay in the CTrie for lookups and derived structures
+void Dictionary::flatten(unsigned bfs_levels, bool huge_pages) {
+    if (flat_trie && !flat_copy) return;
+    flat_copy.reset(
+        new FlatTrie(words, loaded_lexicons, bfs_levels, huge_pages));
+    flat_trie = flat_copy.get();
+}
+
+const FlatTrie* Dictionary::flat() const { return flat_trie; }
+
+bool Dictionary::flattened() const { return flat_copy != nullptr; }
+
+const CTrie& Dictionary::trie() const {
+    if (!flat_trie || flat_copy) return words;
+    std::call_once(words_once,
+                   [this]() { flat_words.reset(new CTrie(flat_trie->toCTrie())); });
+    return *flat_words;
+}
+
+// build the compressed copy the first time any thread asks for it
+const RTrie& Dictionary::radix() const {
+    std::call_once(radix_once, [this]() { radix_trie.reset(new RTrie(trie())); });
+    return *radix_trie;
+}
+
+unsigned Dictionary::lexicons() const { return loaded_lexicons; }
+
+std::vector<std::pair<std::string, unsigned> > Dictionary::wordList() const {
+    if (flat_trie && !flat_copy) return flat_trie->wordList();
+    return words.wordList();
+}
@@ -0,0 +1,143 @@
+#ifndef __DICTIONARY_H__
+#define __DICTIONARY_H__
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "CTrie.h"
+#include "Completer.h"
+#include "FlatTrie.h"
+#include "RTrie.h"
+#include "WordDelta.h"
+#include "WordSet.h"
+
+// A word list (or several lexicons) ready for solving. Build one with
+// load_file, then hand it out as a std::shared_ptr<const Dictionary>:
+// from then on it is read-only and any number of WordHunt objects, on any
+// threads, can search it at once.
+class Dictionary {
+   public:
+    Dictionary();
+    // copies the words only, derived structures are rebuilt on demand. A
+    // copy of a FlatTrie dictionary gets its words as a CTrie, a flattened
+    // one is flattened again.
+    Dictionary(const Dictionary& rhs);
+
+    // load a word list into the given lexicon (0-31). Only call this
+    // before the dictionary is shared. Returns false, loading nothing, if
+    // the file can't be opened or the dictionary is flat (see flatten and
+    // fromFlat).
+    bool load_file(const std::string& filename, unsigned lexicon = 0);
+
+    // apply a delta to the loaded words in place, in time proportional to
+    // the delta (see WordDelta); added words outside the word lengths are
+    // skipped. The word index and a radix copy already built are patched
+    // too and completions are dropped. A flattened copy has removed words
+    // cleared in place but is flattened again in full if words were added,
+    // and a dictionary over a pre-built FlatTrie (which can't change)
+    // first takes all its words into a CTrie. Only call this before
+    // sharing.
+    // Returns the number of changes that did anything.
+    unsigned long applyDelta(const WordDelta& delta);
+
+    // only load words of min_length to max_length letters from now on.
+    void setWordLengths(unsigned min_length, unsigned max_length);
+    unsigned minLength() const;
+    unsigned maxLength() const;
+
+    // also keep the words in a hash set, making lookup/contains a single
+    // hash probe instead of a trie walk. Only call this before sharing.
+    void setWordIndex(bool enable);
+
+    // lexicons a word belongs to, 0 if it isn't in the dictionary.
+    unsigned lookup(const std::string& word) const;
+    bool contains(const std::string& word) const;
+
+    // lookup() for many words at once, results in the same order. Without
+    // the hash set the trie is walked once for the whole batch.
+    std::vector<unsigned> lookupAll(const std::vector<std::string>& words) const;
+
+    // the hash set index, nullptr unless setWordIndex(true) was called.
+    const WordSet* wordIndex() const;
+
+    // rank completions by the given word frequencies (see
+    // Completer::readCounts), caching the top_k best below every prefix.
+    // Words missing from counts rank last, counts for words that aren't
+    // in the dictionary are ignored. Call after loading, loading more
+    // words drops the completions. Only call this before sharing.
+    void setCompletions(
+        const std::vector<std::pair<std::string, unsigned long> >& counts,
+        unsigned top_k);
+
+    // the Completer setCompletions would keep, built for the caller
+    // instead, so a shared dictionary needn't be copied to get one.
+    std::unique_ptr<Completer> buildCompleter(
+        const std::vector<std::pair<std::string, unsigned long> >& counts,
+        unsigned top_k) const;
+
+    // up to k dictionary words starting with prefix, most frequent first.
+    // Empty unless setCompletions was called.
+    std::vector<std::string> complete(const std::string& prefix,
+                                      unsigned k) const;
+
+    // the completion index, nullptr unless setCompletions was called.
+    const Completer* completer() const;
+
+    // shorthand for a dictionary holding one word list in lexicon 0,
+    // nullptr if the file can't be opened.
+    static std::shared_ptr<const Dictionary> fromFile(
+        const std::string& filename);
+
+    // a dictionary over a pre-built FlatTrie, which must outlive it (e.g.
+    // embeddedDictionary()). Nothing is read, parsed or allocated.
+    static std::shared_ptr<const Dictionary> fromFlat(const FlatTrie& flat);
+
+    // search a FlatTrie copy of the loaded words instead of the CTrie,
+    // with bfs_levels levels breadth first and the rest subtree by subtree
+    // (see FlatTrie), optionally on huge pages. Call after loading, only
+    // before sharing; no more files can be loaded afterwards.
+    void flatten(unsigned bfs_levels = FlatTrie::BFS_LEVELS,
+                 bool huge_pages = false);
+
+    // the FlatTrie the solver searches: the one this dictionary was made
+    // from or its flattened copy, nullptr if neither.
+    const FlatTrie* flat() const;
+
+    // whether flat() is a copy made by flatten().
+    bool flattened() const;
+
+    // the words as a CTrie. For a FlatTrie dictionary this is built once,
+    // on first use.
+    const CTrie& trie() const;
+
+    // path-compressed copy of trie(), built once on first use.
+    const RTrie& radix() const;
+
+    // lexicons that have had a file loaded into them.
+    unsigned lexicons() const;
+
+   private:
+    CTrie words;
+    unsigned loaded_lexicons;
+    unsigned min_length, max_length;
+    std::unique_ptr<WordSet> index;
+    std::unique_ptr<Completer> completions;
+
+    const FlatTrie* flat_trie;
+    std::unique_ptr<FlatTrie> flat_copy;
+    mutable std::once_flag words_once;
+    mutable std::unique_ptr<CTrie> flat_words;
+
+    mutable std::once_flag radix_once;
+    mutable std::unique_ptr<RTrie> radix_trie;
+
+    // every word with its lexicons, from a pre-built FlatTrie without
+    // building its CTrie.
+    std::vector<std::pair<std::string, unsigned> > wordList() const;
+
+    Dictionary& operator=(const Dictionary&) = delete;
+};
+
+#endif
@@ -0,0 +1,92 @@
+#include "DictionaryStore.h"
+
+#include <chrono>
+
+DictionaryStore::DictionaryStore(std::shared_ptr<const Dictionary> initial)
+    : busy(false) {
+    std::shared_ptr<const Snapshot> first(new Snapshot{initial, 1});
+    std::atomic_store(&snapshot, first);
+}
+
+DictionaryStore::~DictionaryStore() { wait(); }
+
+std::shared_ptr<const Dictionary> DictionaryStore::current(
+    unsigned long* version) const {
+    std::shared_ptr<const Snapshot> s = std::atomic_load(&snapshot);
+    if (version) *version = s->version;
+    return s->dict;
+}
+
+DictionaryStore::Report DictionaryStore::reload(const Builder& build) {
+    std::lock_guard<std::mutex> guard(reload_lock);
+    auto start = std::chrono::steady_clock::now();
+    std::shared_ptr<const Dictionary> next = build();
+    auto stop = std::chrono::steady_clock::now();
+
+    Report report;
+    report.build_ms =
+        std::chrono::duration_cast<std::chrono::microseconds>(stop - start)
+            .count() /
+        1e3;
+    // only reloads store, and they hold reload_lock
+    unsigned long version = std::atomic_load(&snapshot)->version;
+    report.published = next != nullptr;
+    if (!next) {
+        report.version = version;
+        report.words = 0;
+        return report;
+    }
+    std::shared_ptr<const Snapshot> s(new Snapshot{next, version + 1});
+    std::atomic_store(&snapshot, s);
+    report.version = version + 1;
+    // count a compiled in dictionary without building its CTrie
+    report.words = next->flat() ? next->flat()->shape().endpoints
+                                : next->trie().subtreeWords();
+    return report;
+}
+
+bool DictionaryStore::reloadAsync(const Builder& build,
+                                  std::function<void(const Report&)> done) {
+    if (busy.exchange(true)) return false;
+    std::lock_guard<std::mutex> guard(worker_lock);
+    // the previous worker has finished, it cleared busy on its way out
+    if (worker.joinable()) worker.join();
+    worker = std::thread([this, build, done]() {
+        Report report = reload(build);
+        if (done) done(report);
+        busy = false;
+    });
+    return true;
+}
+
+void DictionaryStore::wait() {
+    std::lock_guard<std::mutex> guard(worker_lock);
+    if (worker.joinable()) worker.join();
+}
+
+DictionaryStore::Builder DictionaryStore::fromFiles(
+    const std::vector<std::string>& files) const {
+    return fromFiles(files, *current());
+}
+
+DictionaryStore::Builder DictionaryStore::fromFiles(
+    const std::vector<std::string>& files, const Dictionary& like) {
+    unsigned min_length = like.minLength(), max_length = like.maxLength();
+    bool index = like.wordIndex() != nullptr;
+    bool flatten = like.flattened();
+    unsigned bfs_levels = flatten ? like.flat()->bfsLevels() : 0;
+    bool huge_pages = flatten && like.flat()->hugePages();
+    return [files, min_length, max_length, index, flatten, bfs_levels,
+            huge_pages]() {
+        std::shared_ptr<Dictionary> dict = std::make_shared<Dictionary>();
+        dict->setWordLengths(min_length, max_length);
+        dict->setWordIndex(index);
+        for (unsigned i = 0; i < files.size() && i < 32; i++) {
+            if (!dict->load_file(files[i], i)) {
+                return std::shared_ptr<const Dictionary>();
+            }
+        }
+        if (flatten) dict->flatten(bfs_levels, huge_pages);
+        return std::shared_ptr<const Dictionary>(dict);
+    };
+}
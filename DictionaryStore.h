@@ -0,0 +1,83 @@
+#ifndef __DICTIONARYSTORE_H__
+#define __DICTIONARYSTORE_H__
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Dictionary.h"
+
+// Holds the current version of a dictionary for a long-running process and
+// lets it be replaced while solvers keep running. Readers take a reference
+// to the current version with one atomic load and search it without locks;
+// a reload builds the new version off to the side and publishes it with
+// one atomic store. Solves already running finish on the version they
+// started with, and an old version is freed when its last reader drops it.
+class DictionaryStore {
+   public:
+    // what a reload did.
+    struct Report {
+        bool published;         // false if the builder failed
+        unsigned long version;  // the version now current
+        double build_ms;        // time to build the new dictionary
+        unsigned long words;    // distinct words in it
+    };
+
+    // builds a new version, or returns nullptr if it can't (e.g. a word
+    // list is missing) and the current version should stay.
+    typedef std::function<std::shared_ptr<const Dictionary>()> Builder;
+
+    explicit DictionaryStore(std::shared_ptr<const Dictionary> initial);
+    // waits for a background reload to finish.
+    ~DictionaryStore();
+
+    DictionaryStore(const DictionaryStore&) = delete;
+    DictionaryStore& operator=(const DictionaryStore&) = delete;
+
+    // the current dictionary, and its version number if version is given.
+    // Safe to call from any thread at any time.
+    std::shared_ptr<const Dictionary> current(
+        unsigned long* version = nullptr) const;
+
+    // build a new dictionary on this thread and make it current.
+    Report reload(const Builder& build);
+
+    // the same on a background thread, done (if set) is called from that
+    // thread with the report. Returns false, doing nothing, while another
+    // background reload is still running.
+    bool reloadAsync(const Builder& build,
+                     std::function<void(const Report&)> done = nullptr);
+
+    // wait for a background reload to finish.
+    void wait();
+
+    // a builder loading each file into the next lexicon, with the word
+    // length limits, word index and flattening of the current dictionary,
+    // or of like. It fails if any of the files can't be opened.
+    Builder fromFiles(const std::vector<std::string>& files) const;
+    static Builder fromFiles(const std::vector<std::string>& files,
+                             const Dictionary& like);
+
+   private:
+    // a published version, never changed once stored.
+    struct Snapshot {
+        std::shared_ptr<const Dictionary> dict;
+        unsigned long version;
+    };
+
+    // only accessed through std::atomic_load/std::atomic_store.
+    std::shared_ptr<const Snapshot> snapshot;
+
+    // serializes reloads, readers never take it.
+    std::mutex reload_lock;
+    // the background reload thread, guarded by worker_lock.
+    std::mutex worker_lock;
+    std::thread worker;
+    std::atomic<bool> busy;
+};
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef __EMBEDDEDDICT_H__
+#define __EMBEDDEDDICT_H__
+
+#include "FlatTrie.h"
+
+// the word list compiled into the program, see "make wordHuntEmbedded".
+// EmbeddedDict.cpp is generated by dictGen from words.txt.
+const FlatTrie& embeddedDictionary();
+
+#endif
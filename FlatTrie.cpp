@@ -0,0 +1,165 @@
+#include <sys/mman.h>
+
+#include <utility>
+
+#include "FlatTrie.h"
+
+//view constructor
+FlatTrie::FlatTrie(const FlatNode* nodes, unsigned long count, unsigned lexicons): nodes(nodes), count(count), loaded(lexicons), levels(~0u), huge(false) {
+}
+
+//flatten constructor: number the nodes breadth first down to bfsLevels,
+//then subtree by subtree below that, and copy them into place. Children
+//are always numbered as a block after their parent, so the self-relative
+//offsets are positive either way.
+FlatTrie::FlatTrie(const CTrie& ct, unsigned lexicons, unsigned bfsLevels, bool hugePages): loaded(lexicons), levels(bfsLevels), huge(hugePages) {
+    //order[i] is the node numbered i, first[i] the number of its first child
+    std::vector<const CTrie *> order(1, &ct);
+    std::vector<uint32_t> first(1, 0);
+    auto placeChildren = [&](uint32_t at) {
+        first[at] = order.size();
+        for (char c = 'a'; c <= 'z'; c++) {
+            const CTrie *next = order[at]->getChild(c);
+            if (next) order.push_back(next);
+        }
+        first.resize(order.size(), 0);
+    };
+    //the top levels, a level at a time
+    uint32_t level_begin = 0, level_end = 1;
+    for (unsigned level = 0; level < bfsLevels && level_begin < level_end; level++) {
+        for (uint32_t i = level_begin; i < level_end; i++) placeChildren(i);
+        level_begin = level_end;
+        level_end = order.size();
+    }
+    //below them each node's children, then each child's subtree in turn
+    std::vector<uint32_t> stack;
+    for (uint32_t i = level_begin; i < level_end; i++) {
+        stack.push_back(i);
+        while (!stack.empty()) {
+            uint32_t at = stack.back();
+            stack.pop_back();
+            placeChildren(at);
+            for (uint32_t c = order.size(); c-- > first[at];) stack.push_back(c);
+        }
+    }
+
+    count = order.size();
+    unsigned long bytes = count * sizeof(FlatNode);
+    void *memory = nullptr;
+    if (hugePages) {
+        //whole 2 MiB pages, the kernel won't use a huge page for a partial one
+        const unsigned long page = 2ul << 20;
+        bytes = (bytes + page - 1) & ~(page - 1);
+        if (posix_memalign(&memory, page, bytes) == 0) madvise(memory, bytes, MADV_HUGEPAGE);
+        else memory = nullptr;
+    }
+    if (!memory) memory = malloc(bytes);
+    owned.reset(static_cast<FlatNode *>(memory));
+    FlatNode *out = owned.get();
+    for (unsigned long i = 0; i < count; i++) {
+        const CTrie *node = order[i];
+        FlatNode &flat = out[i];
+        flat.childMask = 0;
+        for (char c = 'a'; c <= 'z'; c++) {
+            if (node->getChild(c)) flat.childMask |= 1u << (c - 'a');
+        }
+        flat.firstChild = flat.childMask ? first[i] - i : 0;
+        flat.lexiconMask = node->lexicons();
+        flat.letterMask = node->subtreeLetters();
+        flat.requiredMask = node->requiredLetters();
+        flat.wordCount = node->subtreeWords();
+        flat.minRemain = node->minRemaining() > 0xffff ? 0xffff : node->minRemaining();
+        flat.maxRemain = node->maxRemaining() > 0xffff ? 0xffff : node->maxRemaining();
+    }
+    nodes = out;
+}
+
+//find the lexicons a word belongs to
+unsigned FlatTrie::lookup(const std::string& word) const {
+    const FlatNode *temp = nodes;
+    for (unsigned i = 0; i < word.length() && temp; i++) {
+        temp = temp->getChild(word[i]);
+    }
+    if (!temp) return 0;
+    return temp->lexicons();
+}
+
+//clear the endpoint's lexicons, only owned nodes may be written to
+bool FlatTrie::remove(const std::string& word, unsigned lexicons) {
+    if (!owned) return false;
+    const FlatNode *temp = nodes;
+    for (unsigned i = 0; i < word.length() && temp; i++) {
+        temp = temp->getChild(word[i]);
+    }
+    if (!temp || !(temp->lexiconMask & lexicons)) return false;
+    owned.get()[temp - nodes].lexiconMask &= ~lexicons;
+    return true;
+}
+
+//walk the words in order with an explicit stack of (node, letter) frames
+std::vector<std::pair<std::string, unsigned> > FlatTrie::wordList() const {
+    std::vector<std::pair<std::string, unsigned> > out;
+    std::string word;
+    std::vector<std::pair<const FlatNode *, char> > stack;
+    stack.push_back(std::make_pair(nodes, 'a'));
+    while (!stack.empty()) {
+        const FlatNode *node = stack.back().first;
+        char &c = stack.back().second;
+        //skip to the next letter with a link
+        while (c <= 'z' && !(node->childMask & (1u << (c - 'a')))) c++;
+        if (c > 'z') {
+            stack.pop_back();
+            if (!stack.empty()) word.pop_back();
+            continue;
+        }
+        const FlatNode *next = node->getChild(c);
+        word.push_back(c);
+        c++;
+        if (next->isEndpoint()) out.push_back(std::make_pair(word, next->lexicons()));
+        stack.push_back(std::make_pair(next, 'a'));
+    }
+    return out;
+}
+
+CTrie FlatTrie::toCTrie() const {
+    CTrie ct;
+    std::vector<std::pair<std::string, unsigned> > words = wordList();
+    for (unsigned long i = 0; i < words.size(); i++) ct.insert(words[i].first, words[i].second);
+    return ct;
+}
+
+//summarize size and shape, the array has no per node overhead
+TrieShape FlatTrie::shape() const {
+    TrieShape ts;
+    std::vector<std::pair<const FlatNode *, unsigned long> > stack;
+    stack.push_back(std::make_pair(nodes, 0ul));
+    while (!stack.empty()) {
+        const FlatNode *node = stack.back().first;
+        unsigned long level = stack.back().second;
+        stack.pop_back();
+        ts.addNode(node->numChildren(), level, node->isEndpoint());
+        for (unsigned i = 0; i < node->numChildren(); i++) {
+            stack.push_back(std::make_pair(node + node->firstChild + i, level + 1));
+        }
+    }
+    ts.bytes = count * sizeof(FlatNode);
+    return ts;
+}
+
+//write the nodes as a static array and a function returning a view of it
+void FlatTrie::writeSource(std::ostream& os, const std::string& name) const {
+    os << "// generated by dictGen, do not edit\n";
+    os << "#include \"FlatTrie.h\"\n\n";
+    os << "static const FlatNode " << name << "_nodes[" << count << "] = {\n";
+    for (unsigned long i = 0; i < count; i++) {
+        const FlatNode &n = nodes[i];
+        os << "{" << n.childMask << "u," << n.firstChild << "u," << n.lexiconMask << "u,"
+           << n.letterMask << "u," << n.requiredMask << "u," << n.wordCount << "u,"
+           << n.minRemain << "," << n.maxRemain << "},\n";
+    }
+    os << "};\n\n";
+    os << "const FlatTrie& " << name << "() {\n";
+    os << "    static const FlatTrie trie(" << name << "_nodes, " << count << "ul, " << loaded << "u);\n";
+    os << "    return trie;\n";
+    os << "}\n";
+}
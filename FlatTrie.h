@@ -0,0 +1,198 @@
+#ifndef FLATTRIE_H
+#define FLATTRIE_H
+
+#include <memory>
+#include <ostream>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "CTrie.h"
+#include "TrieShape.h"
+
+/**
+ * One node of a FlatTrie. Nodes are plain data so a whole trie can live in a
+ * static const array; a node finds its children through an offset from
+ * itself, so no pointers need relocating.
+ */
+struct FlatNode {
+  /** bit c - 'a' is set when there is a link labeled c */
+  uint32_t childMask;
+  /** distance from this node to its first child, the children follow each
+   *  other in letter order */
+  uint32_t firstChild;
+  uint32_t lexiconMask;
+  uint32_t letterMask;
+  uint32_t requiredMask;
+  uint32_t wordCount;
+  uint16_t minRemain;
+  uint16_t maxRemain;
+
+  /**
+   * \return the number of children
+   */
+  unsigned numChildren() const { return __builtin_popcount(childMask); }
+
+  /**
+   * \return true if there are any children, false otherwise
+   */
+  bool hasChild() const { return childMask != 0; }
+
+  /**
+   * \param character the link label to look for
+   * \return true if there is a link labeled character
+   */
+  bool hasChild(char character) const { return getChild(character) != nullptr; }
+
+  /**
+   * \param character the link label to follow
+   * \return the child reached by the link, nullptr if there is none
+   */
+  const FlatNode* getChild(char character) const {
+    if (character < 'a' || character > 'z') return nullptr;
+    uint32_t bit = 1u << (character - 'a');
+    if (!(childMask & bit)) return nullptr;
+    return this + firstChild + __builtin_popcount(childMask & (bit - 1));
+  }
+
+  /**
+   * The summaries below mean the same as the CTrie accessors of the same
+   * names.
+   */
+  bool isEndpoint() const { return lexiconMask != 0; }
+  unsigned lexicons() const { return lexiconMask; }
+  unsigned subtreeLetters() const { return letterMask; }
+  unsigned requiredLetters() const { return requiredMask; }
+  unsigned minRemaining() const { return minRemain; }
+  unsigned maxRemaining() const { return maxRemain; }
+  unsigned subtreeWords() const { return wordCount; }
+};
+
+/**
+ * A read-only trie stored as one array of FlatNodes. It either owns its
+ * nodes (built from a CTrie) or views an array that outlives it, e.g. one
+ * compiled into the program by dictGen. Only links labeled a-z are kept.
+ *
+ * The top levels, which a board search keeps coming back to, are laid out
+ * breadth first so each level is packed together. Below them every
+ * subtree is contiguous: a node's children come first, then the subtree of
+ * each child in turn, so following a chain of single children reads
+ * consecutive nodes instead of jumping a whole level ahead per letter.
+ */
+class FlatTrie {
+public:
+  /** levels below the root laid out breadth first by default, about 2.7 MB
+   *  of nodes for words.txt */
+  static const unsigned BFS_LEVELS = 6;
+  /**
+   * View an existing node array, nothing is copied.
+   * \param nodes the nodes, nodes[0] is the root
+   * \param count the number of nodes
+   * \param lexicons bitmask of the lexicons loaded into the trie
+   */
+  FlatTrie(const FlatNode* nodes, unsigned long count, unsigned lexicons);
+
+  /**
+   * Flatten a CTrie into nodes owned by this FlatTrie.
+   * \param ct the trie to flatten
+   * \param lexicons bitmask of the lexicons loaded into ct
+   * \param bfsLevels the number of levels below the root laid out breadth
+   *        first, ~0u for the whole trie
+   * \param hugePages put the nodes on 2 MiB aligned memory and ask the
+   *        kernel to back it with transparent huge pages
+   */
+  explicit FlatTrie(const CTrie& ct, unsigned lexicons = 1, unsigned bfsLevels = BFS_LEVELS,
+                    bool hugePages = false);
+
+  FlatTrie(const FlatTrie& rhs) = delete;
+  FlatTrie& operator=(const FlatTrie& rhs) = delete;
+
+  /**
+   * \return the root node
+   */
+  const FlatNode* root() const { return nodes; }
+
+  /**
+   * \return the number of nodes, including the root
+   */
+  unsigned long numNodes() const { return count; }
+
+  /**
+   * \return bitmask of the lexicons loaded into the trie
+   */
+  unsigned lexicons() const { return loaded; }
+
+  /**
+   * \return the layout options the nodes were built with, ~0u and false
+   *         for a view
+   */
+  unsigned bfsLevels() const { return levels; }
+  bool hugePages() const { return huge; }
+
+  /**
+   * \return true if the nodes were built by this FlatTrie, false for a view
+   */
+  bool ownsNodes() const { return owned != nullptr; }
+
+  /**
+   * Find the lexicons a given word belongs to.
+   * \param word the word to find.
+   * \return bitmask of lexicons containing the word, 0 if it is not a member
+   */
+  unsigned lookup(const std::string &word) const;
+
+  /**
+   * Remove a word from one or more lexicons in place. The nodes can't move,
+   * so a word in no lexicon is only marked as no longer ending, and the
+   * subtree summaries are left as they were: they were bounds over more
+   * words, which still hold for fewer, so searches stay correct and just
+   * prune a little less (subtreeWords still counts the removed words). A
+   * view's nodes can't be changed at all, and no word can be added in
+   * place; rebuild from a CTrie for those.
+   * \param word the word to remove
+   * \param lexicons bitmask of lexicons to remove the word from
+   * \return true if the word was in any of those lexicons, false if not
+   *         or if this is a view
+   */
+  bool remove(const std::string &word, unsigned lexicons = ~0u);
+
+  /**
+   * \return every word with the bitmask of lexicons it belongs to, in
+   *         alphabetical order, like CTrie::wordList
+   */
+  std::vector<std::pair<std::string, unsigned> > wordList() const;
+
+  /**
+   * Rebuild the words as a CTrie, for code that needs one.
+   * \return a CTrie holding the same words and lexicons
+   */
+  CTrie toCTrie() const;
+
+  /**
+   * \return the number of nodes, endpoints, fan-out and depth histograms
+   *         and the bytes taken by the node array
+   */
+  TrieShape shape() const;
+
+  /**
+   * Write C++ source defining `const FlatTrie& name()`, which returns a
+   * FlatTrie viewing a static const copy of the nodes.
+   * \param os the stream to write the source to
+   * \param name the name of the function to define
+   */
+  void writeSource(std::ostream& os, const std::string& name) const;
+
+private:
+  struct Free {
+    void operator()(FlatNode* p) const { free(p); }
+  };
+  std::unique_ptr<FlatNode, Free> owned;
+  const FlatNode* nodes;
+  unsigned long count;
+  unsigned loaded;
+  unsigned levels;
+  bool huge;
+};
+
+#endif
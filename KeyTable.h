@@ -0,0 +1,148 @@
+#ifndef KEYTABLE_H
+#define KEYTABLE_H
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "TrieShape.h"
+
+/**
+ * Interns the keys of a TTrie: each distinct key gets a dense id (0, 1, 2,
+ * ... in order of first insertion) so trie nodes can store and compare
+ * small integers instead of the keys themselves. Keys need operator< (for
+ * ranks) and std::hash.
+ */
+template <typename T>
+class KeyTable {
+public:
+  /** id returned by find() for a key that was never interned */
+  static const unsigned NONE = ~0u;
+
+  /**
+   * \param key a key
+   * \return the key's id, or NONE if it was never interned
+   */
+  unsigned find(const T& key) const {
+    typename std::unordered_map<T, unsigned>::const_iterator i = ids.find(key);
+    return i == ids.end() ? NONE : i->second;
+  }
+
+  /**
+   * \param key a key
+   * \return the key's id, giving it the next free id if it is new
+   */
+  unsigned intern(const T& key) {
+    std::pair<typename std::unordered_map<T, unsigned>::iterator, bool> i =
+        ids.emplace(key, keys.size());
+    if (i.second) keys.push_back(key);
+    return i.first->second;
+  }
+
+  /**
+   * \param id an id returned by intern()
+   * \return the key with that id
+   */
+  const T& key(unsigned id) const { return keys[id]; }
+
+  /**
+   * \return the number of keys interned
+   */
+  unsigned size() const { return keys.size(); }
+
+  /**
+   * \param rhs another table
+   * \return true if every key present in both tables has the same id in
+   *         each, so ids can be compared across them directly
+   */
+  bool sameIds(const KeyTable& rhs) const {
+    unsigned n = std::min(size(), rhs.size());
+    for (unsigned i = 0; i < n; i++) {
+      if (keys[i] < rhs.keys[i] || rhs.keys[i] < keys[i]) return false;
+    }
+    return true;
+  }
+
+  /**
+   * \return rank[id] = position of the key among all keys in sorted order
+   */
+  std::vector<unsigned> ranks() const {
+    std::vector<unsigned> order(keys.size()), rank(keys.size());
+    for (unsigned i = 0; i < order.size(); i++) order[i] = i;
+    std::sort(order.begin(), order.end(), ByKey(keys));
+    for (unsigned i = 0; i < order.size(); i++) rank[order[i]] = i;
+    return rank;
+  }
+
+  /**
+   * \return estimated heap bytes, including malloc chunk overhead
+   */
+  unsigned long bytes() const {
+    unsigned long total = sizeof(KeyTable);
+    total += TrieShape::heapBytes(keys.capacity() * sizeof(T));
+    total += TrieShape::heapBytes(ids.bucket_count() * sizeof(void*));
+    //hash nodes hold a next pointer, the pair and the cached hash
+    total += ids.size() * TrieShape::heapBytes(2 * sizeof(void*) + sizeof(std::pair<const T, unsigned>));
+    for (unsigned i = 0; i < keys.size(); i++) total += 2 * TrieShape::keyBytes(keys[i]);
+    return total;
+  }
+
+private:
+  struct ByKey {
+    const std::vector<T>& keys;
+    explicit ByKey(const std::vector<T>& k) : keys(k) {}
+    bool operator()(unsigned a, unsigned b) const { return keys[a] < keys[b]; }
+  };
+  std::unordered_map<T, unsigned> ids;
+  std::vector<T> keys;
+};
+
+/**
+ * chars index a flat table instead of hashing.
+ */
+template <>
+class KeyTable<char> {
+public:
+  static const unsigned NONE = ~0u;
+
+  KeyTable() { std::fill(ids, ids + 256, NONE); }
+
+  unsigned find(char key) const { return ids[(unsigned char)key]; }
+
+  unsigned intern(char key) {
+    unsigned &id = ids[(unsigned char)key];
+    if (id == NONE) {
+      id = keys.size();
+      keys.push_back(key);
+    }
+    return id;
+  }
+
+  const char& key(unsigned id) const { return keys[id]; }
+
+  unsigned size() const { return keys.size(); }
+
+  bool sameIds(const KeyTable& rhs) const {
+    unsigned n = std::min(size(), rhs.size());
+    return std::equal(keys.begin(), keys.begin() + n, rhs.keys.begin());
+  }
+
+  std::vector<unsigned> ranks() const {
+    std::vector<unsigned> rank(keys.size());
+    std::vector<char> sorted(keys);
+    std::sort(sorted.begin(), sorted.end());
+    for (unsigned i = 0; i < sorted.size(); i++) rank[find(sorted[i])] = i;
+    return rank;
+  }
+
+  unsigned long bytes() const {
+    return sizeof(KeyTable) + TrieShape::heapBytes(keys.capacity());
+  }
+
+private:
+  unsigned ids[256];
+  std::vector<char> keys;
+};
+
+#endif // KEYTABLE_H
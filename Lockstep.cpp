@@ -0,0 +1,218 @@
+#include "Lockstep.h"
+
+#include <assert.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "PathAutomaton.h"
+
+static_assert(GAME_SIZE == 4, "lockstep lanes hold one 4x4 board per 16 bits");
+
+namespace {
+// tiles of each column, to stop shifts wrapping around a row
+const uint16_t COL_0 = 0x1111;
+const uint16_t COL_3 = 0x8888;
+
+// the board's move table, looked up once.
+const PathAutomaton& moves() {
+    static const PathAutomaton& table = PathAutomaton::forGeometry(4, 4);
+    return table;
+}
+
+// out[b] = (tiles next to any tile in frontier[b]) & tiles[b] for all 16
+// lanes, returns whether any lane is non-zero.
+#if defined(__AVX2__)
+bool candidates(const uint16_t* frontier, const uint16_t* tiles,
+                uint16_t* out) {
+    __m256i f = _mm256_loadu_si256((const __m256i*)frontier);
+    __m256i not_col0 = _mm256_set1_epi16((short)(uint16_t)~COL_0);
+    __m256i not_col3 = _mm256_set1_epi16((short)(uint16_t)~COL_3);
+    __m256i up_down = _mm256_or_si256(_mm256_slli_epi16(f, 4),
+                                      _mm256_srli_epi16(f, 4));
+    __m256i to_right = _mm256_or_si256(
+        _mm256_slli_epi16(f, 1),
+        _mm256_or_si256(_mm256_slli_epi16(f, 5), _mm256_srli_epi16(f, 3)));
+    __m256i to_left = _mm256_or_si256(
+        _mm256_srli_epi16(f, 1),
+        _mm256_or_si256(_mm256_srli_epi16(f, 5), _mm256_slli_epi16(f, 3)));
+    __m256i near = _mm256_or_si256(
+        up_down, _mm256_or_si256(_mm256_and_si256(to_right, not_col0),
+                                 _mm256_and_si256(to_left, not_col3)));
+    __m256i c = _mm256_and_si256(
+        near, _mm256_loadu_si256((const __m256i*)tiles));
+    _mm256_storeu_si256((__m256i*)out, c);
+    return !_mm256_testz_si256(c, c);
+}
+#elif defined(__SSE2__)
+bool candidates(const uint16_t* frontier, const uint16_t* tiles,
+                uint16_t* out) {
+    __m128i not_col0 = _mm_set1_epi16((short)(uint16_t)~COL_0);
+    __m128i not_col3 = _mm_set1_epi16((short)(uint16_t)~COL_3);
+    __m128i any = _mm_setzero_si128();
+    for (int half = 0; half < 2; half++) {
+        __m128i f = _mm_loadu_si128((const __m128i*)(frontier + 8 * half));
+        __m128i up_down = _mm_or_si128(_mm_slli_epi16(f, 4),
+                                       _mm_srli_epi16(f, 4));
+        __m128i to_right = _mm_or_si128(
+            _mm_slli_epi16(f, 1),
+            _mm_or_si128(_mm_slli_epi16(f, 5), _mm_srli_epi16(f, 3)));
+        __m128i to_left = _mm_or_si128(
+            _mm_srli_epi16(f, 1),
+            _mm_or_si128(_mm_srli_epi16(f, 5), _mm_slli_epi16(f, 3)));
+        __m128i near = _mm_or_si128(
+            up_down, _mm_or_si128(_mm_and_si128(to_right, not_col0),
+                                  _mm_and_si128(to_left, not_col3)));
+        __m128i c = _mm_and_si128(
+            near, _mm_loadu_si128((const __m128i*)(tiles + 8 * half)));
+        _mm_storeu_si128((__m128i*)(out + 8 * half), c);
+        any = _mm_or_si128(any, c);
+    }
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(any, _mm_setzero_si128())) != 0xffff;
+}
+#else
+bool candidates(const uint16_t* frontier, const uint16_t* tiles,
+                uint16_t* out) {
+    uint16_t any = 0;
+    for (int b = 0; b < LockstepSolver::LANES; b++) {
+        uint16_t f = frontier[b];
+        uint16_t to_right = (f << 1) | (f << 5) | (f >> 3);
+        uint16_t to_left = (f >> 1) | (f >> 5) | (f << 3);
+        uint16_t near = (f << 4) | (f >> 4) | (to_right & ~COL_0) |
+                        (to_left & ~COL_3);
+        out[b] = near & tiles[b];
+        any |= out[b];
+    }
+    return any != 0;
+}
+#endif
+}  // namespace
+
+LockstepSolver::LockstepSolver(std::shared_ptr<const Dictionary> dict)
+    : dict(dict),
+      group(nullptr),
+      lanes(0),
+      min_length(0),
+      max_depth(GAME_SIZE * GAME_SIZE),
+      levels(GAME_SIZE * GAME_SIZE + 2) {}
+
+void LockstepSolver::solve(std::vector<WordHunt>& hunts) {
+    for (int i = 0; i < (int)hunts.size(); i += LANES) {
+        int count = (int)hunts.size() - i;
+        solveGroup(&hunts[i], count < LANES ? count : LANES);
+    }
+}
+
+void LockstepSolver::solveGroup(WordHunt* hunts, int count) {
+    assert(count > 0 && count <= LANES);
+    group = hunts;
+    lanes = count;
+    // prune with the loosest word lengths of the group, record() filters
+    // each board's own
+    min_length = ~0u;
+    max_depth = 0;
+    for (int b = 0; b < count; b++) {
+        if (hunts[b].min_length < min_length) min_length = hunts[b].min_length;
+        unsigned depth = hunts[b].max_length < 16 ? hunts[b].max_length : 16;
+        if (depth > max_depth) max_depth = depth;
+    }
+    for (int l = 0; l < 32; l++) {
+        for (int b = 0; b < LANES; b++) tiles[l][b] = 0;
+    }
+    for (int b = 0; b < count; b++) {
+        assert(hunts[b].dictionary() == dict);
+        const std::string& board = hunts[b].board;
+        assert(board.length() == 16);
+        for (int i = 0; i < 16; i++) {
+            tiles[__builtin_ctz(CTrie::letterBit(board[i]))][b] |= 1 << i;
+        }
+    }
+
+    // depth 1: every tile starts a path on its own board
+    const CTrie& root = dict->trie();
+    for (int l = 0; l < 26; l++) {
+        const CTrie* ct = root.getChild('a' + l);
+        if (!ct) continue;
+        Level& first = levels[1];
+        first.paths.clear();
+        for (int b = 0; b < LANES; b++) {
+            first.begin[b] = first.paths.size();
+            first.frontier[b] = tiles[l][b];
+            for (int i = 0; i < 16; i++) {
+                if (tiles[l][b] & (1 << i)) {
+                    Path p = {(uint8_t)i, (uint8_t)i, (uint16_t)(1 << i)};
+                    first.paths.push_back(p);
+                }
+            }
+        }
+        first.begin[LANES] = first.paths.size();
+        if (first.paths.empty()) continue;
+        word.assign(1, 'a' + l);
+        walk(ct, 1);
+    }
+}
+
+// visit trie node ct, reached on every board by the paths in levels[depth].
+void LockstepSolver::walk(const CTrie* ct, unsigned depth) {
+    const Level& cur = levels[depth];
+    if (ct->isEndpoint()) {
+        for (int b = 0; b < lanes; b++) {
+            if (cur.begin[b] == cur.begin[b + 1]) continue;
+            // solve() credits a word to the first start tile that reaches it,
+            // its analytics to every tile on any of the paths
+            int start = 16, mask = 0;
+            for (int p = cur.begin[b]; p < cur.begin[b + 1]; p++) {
+                if (cur.paths[p].start < start) start = cur.paths[p].start;
+                mask |= cur.paths[p].mask;
+            }
+            group[b].record(ct, ct->lexicons(), word, start, mask);
+        }
+    }
+    if (!ct->hasChild() || depth >= max_depth) return;
+
+    const PathAutomaton& adj = moves();
+    uint16_t around[LANES];
+    // only letters that occur somewhere below ct can have a child
+    unsigned letters = ct->subtreeLetters();
+    while (letters) {
+        int l = __builtin_ctz(letters);
+        letters &= letters - 1;
+        if (l == 31) continue;
+        if (!candidates(cur.frontier, tiles[l], around)) continue;
+        const CTrie* next_ct = ct->getChild('a' + l);
+        if (!next_ct || depth + 1 + next_ct->maxRemaining() < min_length) {
+            continue;
+        }
+
+        // extend each board's paths onto the candidate tiles
+        Level& next = levels[depth + 1];
+        next.paths.clear();
+        bool any = false;
+        for (int b = 0; b < LANES; b++) {
+            next.begin[b] = next.paths.size();
+            next.frontier[b] = 0;
+            if (!around[b]) continue;
+            for (int p = cur.begin[b]; p < cur.begin[b + 1]; p++) {
+                const Path& path = cur.paths[p];
+                unsigned step = adj.next(path.tile, path.mask) & around[b];
+                while (step) {
+                    int t = __builtin_ctz(step);
+                    step &= step - 1;
+                    Path q = {path.start, (uint8_t)t,
+                              (uint16_t)(path.mask | (1 << t))};
+                    next.paths.push_back(q);
+                    next.frontier[b] |= 1 << t;
+                    any = true;
+                }
+            }
+        }
+        next.begin[LANES] = next.paths.size();
+        if (!any) continue;
+        word.push_back('a' + l);
+        walk(next_ct, depth + 1);
+        word.pop_back();
+    }
+}
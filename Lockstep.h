@@ -0,0 +1,66 @@
+#ifndef __LOCKSTEP_H__
+#define __LOCKSTEP_H__
+
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "Dictionary.h"
+#include "WordHunt.h"
+
+// Solves up to LANES boards at once: the trie is walked a single time and
+// every node is tried against all boards together. Each board keeps its own
+// paths (start tile, last tile, visited mask); the boards' frontiers sit in
+// 16-bit SIMD lanes so a link that no board can follow is skipped for all of
+// them with a few vector ops (AVX2 or SSE2 when the compiler targets them,
+// plain loops otherwise).
+//
+// Each board gets the same words, lexicons and start tiles as
+// WordHunt::solve; the words under a start tile come out in alphabetical
+// order instead of search order. Boards and words are limited to a-z.
+class LockstepSolver {
+   public:
+    static const int LANES = 16;
+
+    explicit LockstepSolver(std::shared_ptr<const Dictionary> dict);
+
+    // solve every hunt's current board (see WordHunt::setBoard), LANES at a
+    // time. The hunts must all use this solver's dictionary.
+    void solve(std::vector<WordHunt>& hunts);
+
+    // solve hunts[0, count), count <= LANES.
+    void solveGroup(WordHunt* hunts, int count);
+
+   private:
+    // one way of spelling the current prefix on a board.
+    struct Path {
+        uint8_t start;
+        uint8_t tile;
+        uint16_t mask;
+    };
+
+    // the paths of every board at one trie depth: board b owns
+    // paths[begin[b], begin[b + 1]), frontier[b] has their last tiles.
+    struct Level {
+        std::vector<Path> paths;
+        int begin[LANES + 1];
+        uint16_t frontier[LANES];
+    };
+
+    std::shared_ptr<const Dictionary> dict;
+
+    WordHunt* group;
+    int lanes;
+    unsigned min_length, max_depth;
+    // tiles[l][b]: tiles of board b holding the letter with CTrie::letterBit
+    // index l.
+    uint16_t tiles[32][LANES];
+    // one level per depth, sized up front so references stay valid.
+    std::vector<Level> levels;
+    std::string word;
+
+    void walk(const CTrie* ct, unsigned depth);
+};
+
+#endif
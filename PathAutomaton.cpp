@@ -0,0 +1,34 @@
+#include "PathAutomaton.h"
+
+#include <assert.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+PathAutomaton::PathAutomaton(int rows, int cols) : num_tiles(rows * cols) {
+    assert(rows > 0 && cols > 0 && rows * cols <= 32);
+    for (int i = 0; i < num_tiles; i++) {
+        steps[i] = 0;
+        for (int x = -1; x <= 1; x++) {
+            for (int y = -1; y <= 1; y++) {
+                int row = i / cols + x, col = i % cols + y;
+                if (row < 0 || row >= rows || col < 0 || col >= cols ||
+                    !(x || y)) {
+                    continue;
+                }
+                steps[i] |= 1u << (cols * row + col);
+            }
+        }
+    }
+}
+
+const PathAutomaton& PathAutomaton::forGeometry(int rows, int cols) {
+    static std::mutex lock;
+    static std::map<std::pair<int, int>, std::unique_ptr<PathAutomaton>> cache;
+    std::lock_guard<std::mutex> guard(lock);
+    std::unique_ptr<PathAutomaton>& entry = cache[std::make_pair(rows, cols)];
+    if (!entry) entry.reset(new PathAutomaton(rows, cols));
+    return *entry;
+}
@@ -0,0 +1,33 @@
+#ifndef __PATHAUTOMATON_H__
+#define __PATHAUTOMATON_H__
+
+#include <stdint.h>
+
+// Letter-independent move table for a rows x cols board (up to 32 tiles):
+// the neighbours of every tile as a bitmask. A search state is (current
+// tile, visited tiles) and the tiles it can move to next are
+// next(tile, visited), so the board search needs no coordinate
+// arithmetic. Taking the bits lowest first gives the order every engine
+// tries neighbours in. All of WordHunt's engines and LockstepSolver use
+// this one table.
+class PathAutomaton {
+   public:
+    // the shared table for a geometry, built on first request. This locks,
+    // so solvers look their geometry up once and keep the reference.
+    static const PathAutomaton& forGeometry(int rows, int cols);
+
+    int tiles() const { return num_tiles; }
+
+    // tiles the path can move to next.
+    uint32_t next(int tile, uint32_t visited) const {
+        return steps[tile] & ~visited;
+    }
+
+   private:
+    PathAutomaton(int rows, int cols);
+
+    int num_tiles;
+    uint32_t steps[32];
+};
+
+#endif
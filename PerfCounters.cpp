@@ -0,0 +1,143 @@
+#include "PerfCounters.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstring>
+
+namespace {
+struct EventSpec {
+    const char* name;
+    uint32_t type;
+    uint64_t config;
+};
+
+uint64_t cacheEvent(uint64_t cache, uint64_t op, uint64_t result) {
+    return cache | (op << 8) | (result << 16);
+}
+
+const EventSpec specs[PerfCounters::NUM_EVENTS] = {
+    {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {"L1d-misses", PERF_TYPE_HW_CACHE,
+     cacheEvent(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ,
+                PERF_COUNT_HW_CACHE_RESULT_MISS)},
+    {"LLC-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {"branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {"dTLB-misses", PERF_TYPE_HW_CACHE,
+     cacheEvent(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ,
+                PERF_COUNT_HW_CACHE_RESULT_MISS)},
+    {"task-clock-ns", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+    {"page-faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+};
+}  // namespace
+
+PerfCounters::Sample& PerfCounters::Sample::operator+=(const Sample& rhs) {
+    for (int e = 0; e < NUM_EVENTS; e++) {
+        value[e] += rhs.value[e];
+        valid[e] = valid[e] || rhs.valid[e];
+    }
+    return *this;
+}
+
+// open every event for this thread on any cpu, counting from now on
+PerfCounters::PerfCounters() {
+    for (int e = 0; e < NUM_EVENTS; e++) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = specs[e].type;
+        attr.config = specs[e].config;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format =
+            PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        fd[e] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (fd[e] < 0 && first_error.empty()) {
+            first_error = std::string(specs[e].name) + ": " + strerror(errno);
+        }
+    }
+    start();
+}
+
+PerfCounters::~PerfCounters() {
+    for (int e = 0; e < NUM_EVENTS; e++) {
+        if (fd[e] >= 0) close(fd[e]);
+    }
+}
+
+bool PerfCounters::available() const {
+    for (int e = 0; e < NUM_EVENTS; e++) {
+        if (fd[e] >= 0) return true;
+    }
+    return false;
+}
+
+const std::string& PerfCounters::error() const { return first_error; }
+
+// value, time enabled, time running
+bool PerfCounters::read(int event, unsigned long long out[3]) const {
+    if (fd[event] < 0) return false;
+    uint64_t buf[3];
+    if (::read(fd[event], buf, sizeof(buf)) != (ssize_t)sizeof(buf)) {
+        return false;
+    }
+    for (int i = 0; i < 3; i++) out[i] = buf[i];
+    return true;
+}
+
+void PerfCounters::start() {
+    for (int e = 0; e < NUM_EVENTS; e++) {
+        if (!read(e, begin[e])) begin[e][0] = begin[e][1] = begin[e][2] = 0;
+    }
+}
+
+// the deltas since start(), scaled by enabled / running time when the
+// event only had a counter part of the time
+PerfCounters::Sample PerfCounters::end() {
+    Sample s;
+    for (int e = 0; e < NUM_EVENTS; e++) {
+        unsigned long long now[3];
+        if (!read(e, now)) continue;
+        unsigned long long value = now[0] - begin[e][0];
+        unsigned long long enabled = now[1] - begin[e][1];
+        unsigned long long running = now[2] - begin[e][2];
+        if (running == 0) {
+            // never scheduled in this interval, only valid if idle
+            if (enabled) continue;
+        } else if (running < enabled) {
+            value = (unsigned long long)((double)value * enabled / running);
+        }
+        s.value[e] = value;
+        s.valid[e] = true;
+    }
+    return s;
+}
+
+const char* PerfCounters::name(Event e) { return specs[e].name; }
+
+void PerfCounters::print(std::ostream& os, const std::string& phase,
+                         const Sample& s, unsigned long nodes) {
+    std::streamsize precision = os.precision(3);
+    os << "Counters (" << phase << "):";
+    bool any = false;
+    for (int e = 0; e < NUM_EVENTS; e++) {
+        if (!s.valid[e]) continue;
+        any = true;
+        os << " " << specs[e].name << " " << s.value[e];
+        // misses and branch mispredicts per trie node visited
+        if (nodes && e >= L1D_MISSES && e <= DTLB_MISSES) {
+            os << " (" << (double)s.value[e] / nodes << "/node)";
+        }
+    }
+    if (s.valid[CYCLES] && s.valid[INSTRUCTIONS] && s.value[CYCLES]) {
+        os << " IPC " << (double)s.value[INSTRUCTIONS] / s.value[CYCLES];
+    }
+    if (!any) os << " unavailable";
+    if (nodes) os << " nodes " << nodes;
+    os << "\n";
+    os.precision(precision);
+}
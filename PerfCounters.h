@@ -0,0 +1,66 @@
+#ifndef __PERF_COUNTERS_H__
+#define __PERF_COUNTERS_H__
+
+#include <ostream>
+#include <string>
+
+// Hardware (and a few software) event counts for the calling thread, read
+// through Linux perf_event_open. Each event is opened on its own, so a
+// machine that lacks some of them, a VM without a PMU or a kernel that
+// forbids them (see /proc/sys/kernel/perf_event_paranoid) still gets the
+// rest. Events that could not be opened are left out of reports; with none
+// at all every call is a cheap no-op.
+class PerfCounters {
+   public:
+    enum Event {
+        CYCLES,
+        INSTRUCTIONS,
+        L1D_MISSES,  // L1 data cache read misses
+        LLC_MISSES,  // last level cache misses
+        BRANCH_MISSES,
+        DTLB_MISSES,  // data TLB read misses
+        TASK_CLOCK,   // nanoseconds on the cpu (software)
+        PAGE_FAULTS,  // software
+        NUM_EVENTS
+    };
+
+    // counts between two reads, scaled up if the kernel had to multiplex
+    // the events.
+    struct Sample {
+        unsigned long long value[NUM_EVENTS] = {};
+        bool valid[NUM_EVENTS] = {};
+        Sample& operator+=(const Sample& rhs);
+    };
+
+    // opens the events, counting user space only.
+    PerfCounters();
+    ~PerfCounters();
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // whether any event could be opened, and why not if some could not
+    // (the first error seen, empty if every event opened).
+    bool available() const;
+    const std::string& error() const;
+
+    // begin a measurement; end() returns the counts since the last start().
+    void start();
+    Sample end();
+
+    static const char* name(Event e);
+
+    // one line for a phase: every valid count, IPC and, given the number of
+    // trie nodes visited, misses per node.
+    static void print(std::ostream& os, const std::string& phase,
+                      const Sample& s, unsigned long nodes);
+
+   private:
+    int fd[NUM_EVENTS];
+    std::string first_error;
+    // raw value, time enabled and time running per event at start()
+    unsigned long long begin[NUM_EVENTS][3];
+
+    bool read(int event, unsigned long long out[3]) const;
+};
+
+#endif
@@ -0,0 +1,225 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "RTrie.h"
+
+//default constructor
+RTrie::RTrie(): lexiconMask(0) {
+}
+
+//build from a CTrie
+RTrie::RTrie(const CTrie& ct): lexiconMask(ct.lexicons()) {
+    this->compress(ct);
+}
+
+//copy constructor
+RTrie::RTrie(const RTrie& rhs) {
+    *this = rhs; //note this is the overloaded assignment operator
+}
+
+//destructor
+RTrie::~RTrie() {
+    this->clear();
+}
+
+//delete all child nodes
+void RTrie::clear() {
+    //Iterate through all children and delete them recursively
+    for (std::map<char, RTrie *>::iterator i = this->child.begin(); i != child.end(); i++) {
+        delete i->second;
+    }
+    this->child.clear();
+}
+
+//assignment operator
+RTrie& RTrie::operator=(const RTrie &rhs) {
+    if (this != &rhs) {
+        //empty left-hand side
+        this->clear();
+        //iterate through rhs' child nodes and copy
+        for (std::map<char, RTrie *>::const_iterator i = rhs.child.begin(); i != rhs.child.end(); i++) {
+            this->child[i->first] = new RTrie(*i->second);
+        }
+        this->edge = rhs.edge;
+        this->lexiconMask = rhs.lexiconMask;
+    }
+    return *this;
+}
+
+//helper to add the compressed children of ct below this node
+void RTrie::compress(const CTrie& ct) {
+    for (std::map<char, CTrie *>::const_iterator i = ct.child.begin(); i != ct.child.end(); i++) {
+        RTrie *node = new RTrie;
+        node->edge.push_back(i->first);
+        //follow the chain while it has exactly one child and no endpoint
+        const CTrie *temp = i->second;
+        while (!temp->isEndpoint() && temp->numChildren() == 1) {
+            node->edge.push_back(temp->child.begin()->first);
+            temp = temp->child.begin()->second;
+        }
+        node->lexiconMask = temp->lexicons();
+        node->compress(*temp);
+        this->child[i->first] = node;
+    }
+}
+
+//walk the word's links, splitting the first one that only partly matches
+RTrie& RTrie::insert(const std::string& word, unsigned lexicons) {
+    if (!lexicons) return *this;
+    RTrie *temp = this;
+    unsigned pos = 0;
+    while (pos < word.length()) {
+        std::map<char, RTrie *>::iterator i = temp->child.find(word[pos]);
+        if (i == temp->child.end()) {
+            //the rest of the word becomes one new link
+            RTrie *leaf = new RTrie;
+            leaf->edge = word.substr(pos);
+            leaf->lexiconMask = lexicons;
+            temp->child[word[pos]] = leaf;
+            return *this;
+        }
+        RTrie *next = i->second;
+        unsigned k = 1;
+        while (k < next->edge.length() && pos + k < word.length() && next->edge[k] == word[pos + k]) k++;
+        if (k < next->edge.length()) {
+            //the word leaves the label after k characters, put a node there
+            RTrie *mid = new RTrie;
+            mid->edge = next->edge.substr(0, k);
+            next->edge.erase(0, k);
+            mid->child[next->edge[0]] = next;
+            i->second = mid;
+            next = mid;
+        }
+        temp = next;
+        pos += k;
+    }
+    temp->lexiconMask |= lexicons;
+    return *this;
+}
+
+//clear the endpoint, then drop or merge the nodes it no longer needs
+bool RTrie::remove(const std::string& word, unsigned lexicons) {
+    RTrie *parent = nullptr, *temp = this;
+    unsigned pos = 0;
+    while (pos < word.length()) {
+        std::map<char, RTrie *>::iterator i = temp->child.find(word[pos]);
+        if (i == temp->child.end() || word.compare(pos, i->second->edge.length(), i->second->edge) != 0) {
+            return false;
+        }
+        parent = temp;
+        temp = i->second;
+        pos += temp->edge.length();
+    }
+    if (!(temp->lexiconMask & lexicons)) return false;
+    temp->lexiconMask &= ~lexicons;
+    if (temp->isEndpoint() || !parent) return true;
+    if (temp->child.empty()) {
+        //a leaf leading to no word, the parent may now have one child left
+        parent->child.erase(temp->edge[0]);
+        delete temp;
+        temp = parent;
+        if (temp == this || temp->isEndpoint()) return true;
+    }
+    if (temp->child.size() == 1) temp->absorbChild();
+    return true;
+}
+
+//merge the only child into this node, joining the two labels
+void RTrie::absorbChild() {
+    RTrie *only = this->child.begin()->second;
+    this->edge += only->edge;
+    this->lexiconMask = only->lexiconMask;
+    std::map<char, RTrie *> grandchildren;
+    grandchildren.swap(only->child);
+    this->child.swap(grandchildren);
+    //grandchildren now holds only the link to the absorbed node
+    delete only;
+}
+
+//find the lexicons a word belongs to
+unsigned RTrie::lookup(const std::string& word) const {
+    const RTrie *temp = this;
+    unsigned pos = 0;
+    while (pos < word.length()) {
+        temp = temp->getChild(word[pos]);
+        if (!temp) return 0;
+        //the whole label has to match the word from here
+        if (word.compare(pos, temp->edge.length(), temp->edge) != 0) return 0;
+        pos += temp->edge.length();
+    }
+    return temp->lexiconMask;
+}
+
+//output stream operator (overload)
+//helper function to take string in as a parameter
+void RTrie::output_trie(std::ostream &os, std::string updated_str) const {
+    std::string fullstr = updated_str;
+    for (std::map<char, RTrie *>::const_iterator i = this->child.begin(); i != this->child.end(); i++) {
+        updated_str = fullstr + i->second->edge;
+        if (i->second->isEndpoint()) os << updated_str << std::endl;
+        i->second->output_trie(os, updated_str);
+    }
+}
+
+std::ostream& operator<<(std::ostream& os, const RTrie& rt) {
+    rt.output_trie(os, "");
+    return os;
+}
+
+//count the nodes in this subtree
+unsigned RTrie::numNodes() const {
+    unsigned count = 1;
+    for (std::map<char, RTrie *>::const_iterator i = this->child.begin(); i != this->child.end(); i++) {
+        count += i->second->numNodes();
+    }
+    return count;
+}
+
+//summarize size and shape, walking the trie with an explicit stack
+TrieShape RTrie::shape() const {
+    TrieShape ts;
+    std::vector<std::pair<const RTrie *, unsigned long> > stack;
+    stack.push_back(std::make_pair(this, 0ul));
+    while (!stack.empty()) {
+        const RTrie *node = stack.back().first;
+        unsigned long level = stack.back().second;
+        stack.pop_back();
+        ts.addNode(node->child.size(), level, node->isEndpoint());
+        ts.bytes += level ? TrieShape::heapBytes(sizeof(RTrie)) : sizeof(RTrie);
+        ts.bytes += TrieShape::keyBytes(node->edge);
+        ts.bytes += node->child.size() * TrieShape::mapEntryBytes(sizeof(std::pair<const char, RTrie *>));
+        for (std::map<char, RTrie *>::const_iterator i = node->child.begin(); i != node->child.end(); i++) {
+            stack.push_back(std::make_pair(i->second, level + 1));
+        }
+    }
+    return ts;
+}
+
+//return true if there are any children, false otherwise
+bool RTrie::hasChild() const {
+    return !this->child.empty();
+}
+
+//get pointer to child node whose label starts with the character
+const RTrie* RTrie::getChild(char character) const {
+    std::map<char, RTrie *>::const_iterator i = this->child.find(character);
+    if (i != child.end()) return i->second;
+    //else
+    return nullptr;
+}
+
+//return the label on the link into this node
+const std::string& RTrie::label() const {
+    return this->edge;
+}
+
+//return true if this node is an endpoint, false otherwise
+bool RTrie::isEndpoint() const {
+    return this->lexiconMask != 0;
+}
+
+//return bitmask of lexicons this endpoint belongs to
+unsigned RTrie::lexicons() const {
+    return this->lexiconMask;
+}
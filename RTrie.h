@@ -0,0 +1,131 @@
+#ifndef RTRIE_H
+#define RTRIE_H
+
+#include <map>
+#include <string>
+
+#include "CTrie.h"
+#include "TrieShape.h"
+
+class RTrie {
+public:
+  /**
+   * Default Constructor.
+   */
+  RTrie();
+
+  /**
+   * Build a path-compressed copy of a CTrie: every chain of nodes with a
+   * single child and no endpoint collapses into one link whose label holds
+   * all of the chain's characters.
+   * \param ct A const reference to the CTrie to compress.
+   */
+  explicit RTrie(const CTrie& ct);
+
+  /**
+   * Copy Constructor.
+   * \param rhs A const reference to the input to copy.
+   */
+  RTrie(const RTrie& rhs);
+
+  /**
+   * Destructor.
+   */
+  ~RTrie();
+
+  /**
+   * Assignment operator.
+   */
+  RTrie& operator=(const RTrie &rhs);
+
+  /**
+   * Add a word to one or more lexicons in place. A link whose label only
+   * partly matches the word is split, so the trie stays the same as one
+   * compressed from a CTrie holding the word. Takes time in the word's
+   * length, not the trie's size.
+   * \param word the word to add
+   * \param lexicons bitmask of lexicons (bit i = lexicon i); 0 adds nothing
+   * \return a reference to the RTrie object
+   */
+  RTrie& insert(const std::string& word, unsigned lexicons);
+
+  /**
+   * Remove a word from one or more lexicons in place. Once it is in none,
+   * its node is deleted if it has no children, and a node left with a
+   * single child and no word of its own is merged with that child, so the
+   * trie stays the same as one compressed from a CTrie without the word.
+   * \param word the word to remove
+   * \param lexicons bitmask of lexicons to remove the word from
+   * \return true if the word was in any of those lexicons
+   */
+  bool remove(const std::string& word, unsigned lexicons = ~0u);
+
+  /**
+   * Find the lexicons a given word belongs to.
+   * \param word the word to find.
+   * \return bitmask of lexicons containing the word, 0 if it is not a member
+   */
+  unsigned lookup(const std::string &word) const;
+
+  /**
+   * \brief Overloaded output stream operator<< to print the RTrie one word
+   *        per line in alphabetical order, exactly like the CTrie it was
+   *        built from.
+   * \param os A reference to the output stream object
+   * \param rt A constant reference to the input RTrie object
+   * \return A reference to the output stream object
+  */
+  friend std::ostream& operator<<(std::ostream& os, const RTrie& rt);
+
+  /**
+   * \return the number of nodes in this RTrie, including this one
+   */
+  unsigned numNodes() const;
+
+  /**
+   * Walk the trie and summarize its size and shape.
+   * \return node and endpoint counts, estimated heap bytes, and fan-out
+   *         and depth histograms
+   */
+  TrieShape shape() const;
+
+  /**
+   * \return true if there are any children, false otherwise
+   */
+  bool hasChild() const;
+
+  /**
+   * Get pointer to child node whose label starts with the specified
+   * character.
+   * \param character a character
+   * \return pointer to child node, or nullptr if there is no such child
+   */
+  const RTrie* getChild(char character) const;
+
+  /**
+   * \return the characters on the link leading into this node (empty for
+   *         the root)
+   */
+  const std::string& label() const;
+
+  /**
+   * \return true if this node is an endpoint, false otherwise
+   */
+  bool isEndpoint() const;
+
+  /**
+   * \return bitmask of lexicons this endpoint belongs to, 0 if not an endpoint
+   */
+  unsigned lexicons() const;
+
+private:
+    std::map<char, RTrie *> child;
+    std::string edge;
+    unsigned lexiconMask;
+    void compress(const CTrie& ct);
+    void absorbChild();
+    void clear();
+    void output_trie(std::ostream &os, std::string updated_str) const;
+};
+
+#endif // RTRIE_H
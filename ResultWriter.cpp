@@ -0,0 +1,289 @@
+#include "ResultWriter.h"
+
+#include <map>
+#include <vector>
+
+ResultWriter::ResultWriter(std::ostream& os, Format format, size_t buffer_size)
+    : os(os), format(format), buffer_size(buffer_size), header_done(false) {
+    buffer.reserve(buffer_size);
+}
+
+ResultWriter::~ResultWriter() { flush(); }
+
+bool ResultWriter::fromName(const std::string& name, Format& format) {
+    if (name == "text") {
+        format = TEXT;
+    } else if (name == "jsonl") {
+        format = JSONL;
+    } else if (name == "csv") {
+        format = CSV;
+    } else if (name == "binary") {
+        format = BINARY;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* ResultWriter::header(Format format) {
+    if (format == CSV) return "board,row,col,word,length,points,lexicons\n";
+    return "";
+}
+
+void ResultWriter::write(const WordHunt& wh) {
+    switch (format) {
+        case TEXT:
+            writeText(wh);
+            break;
+        case JSONL:
+            writeJson(wh);
+            break;
+        case CSV:
+            writeCsv(wh);
+            break;
+        case BINARY:
+            writeBinary(wh);
+            break;
+    }
+    // only touch the stream once a whole buffer's worth is waiting
+    if (buffer.size() >= buffer_size) {
+        os.write(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+}
+
+void ResultWriter::flush() {
+    os.write(buffer.data(), buffer.size());
+    buffer.clear();
+    os.flush();
+}
+
+void ResultWriter::writeText(const WordHunt& wh) {
+    // only tag words with their lexicons when there is more than one.
+    unsigned loaded = wh.dict->lexicons();
+    bool tag = (loaded & (loaded - 1)) != 0;
+    std::map<int, std::vector<std::string>>::const_iterator it;
+    for (it = wh.m_vec.begin(); it != wh.m_vec.end(); ++it) {
+        put("( ");
+        putNumber(it->first / GAME_SIZE);
+        put(", ");
+        putNumber(it->first % GAME_SIZE);
+        put(" ) : ");
+        for (const std::string& word : it->second) {
+            put(word);
+            if (tag) {
+                // e.g. "word[0,2]" for a word in lexicons 0 and 2
+                unsigned lex = wh.lexiconsOf(word);
+                buffer += '[';
+                for (unsigned i = 0, first = 1; i < 32; i++) {
+                    if (lex & (1u << i)) {
+                        if (!first) buffer += ',';
+                        putNumber(i);
+                        first = 0;
+                    }
+                }
+                buffer += ']';
+            }
+            buffer += ' ';
+        }
+        buffer += '\n';
+    }
+    if (!wh.gather) return;
+    // words and points per tile as grids, then what no word touched and
+    // the commonest letter pairs
+    const WordHunt::Analytics& a = wh.stats;
+    const unsigned* grids[2] = {a.tile_words, a.tile_points};
+    const char* names[2] = {"words per tile:\n", "points per tile:\n"};
+    for (int g = 0; g < 2; g++) {
+        put(names[g]);
+        for (int t = 0; t < GAME_SIZE * GAME_SIZE; t++) {
+            buffer += t % GAME_SIZE ? ' ' : '\t';
+            putNumber(grids[g][t]);
+            if (t % GAME_SIZE == GAME_SIZE - 1) buffer += '\n';
+        }
+    }
+    put("unused tiles:");
+    unsigned unused = a.unusedTiles();
+    for (int t = 0; t < GAME_SIZE * GAME_SIZE; t++) {
+        if (!(unused & (1u << t))) continue;
+        put(" ( ");
+        putNumber(t / GAME_SIZE);
+        put(", ");
+        putNumber(t % GAME_SIZE);
+        put(" )");
+    }
+    put("\ntop bigrams:");
+    std::vector<std::pair<std::string, unsigned>> top = a.topBigrams(10);
+    for (size_t i = 0; i < top.size(); i++) {
+        buffer += ' ';
+        put(top[i].first);
+        buffer += ' ';
+        putNumber(top[i].second);
+    }
+    buffer += '\n';
+}
+
+void ResultWriter::writeJson(const WordHunt& wh) {
+    // {"board":"...","words":N,"score":S,"tiles":[{"row":r,"col":c,
+    //  "words":["..."],"lexicons":[mask,...]},...]}
+    put("{\"board\":");
+    putJsonString(wh.board);
+    put(",\"words\":");
+    putNumber(wh.numWords());
+    put(",\"score\":");
+    putNumber(wh.score());
+    put(",\"tiles\":[");
+    std::map<int, std::vector<std::string>>::const_iterator it;
+    for (it = wh.m_vec.begin(); it != wh.m_vec.end(); ++it) {
+        if (it != wh.m_vec.begin()) buffer += ',';
+        put("{\"row\":");
+        putNumber(it->first / GAME_SIZE);
+        put(",\"col\":");
+        putNumber(it->first % GAME_SIZE);
+        put(",\"words\":[");
+        for (size_t i = 0; i < it->second.size(); i++) {
+            if (i) buffer += ',';
+            putJsonString(it->second[i]);
+        }
+        put("],\"lexicons\":[");
+        for (size_t i = 0; i < it->second.size(); i++) {
+            if (i) buffer += ',';
+            putNumber(wh.lexiconsOf(it->second[i]));
+        }
+        put("]}");
+    }
+    put("]");
+    if (wh.gather) {
+        // ,"analytics":{"tile_words":[...],"tile_points":[...],
+        //  "unused":[tile,...],"bigrams":[["th",n],...]}
+        const WordHunt::Analytics& a = wh.stats;
+        put(",\"analytics\":{\"tile_words\":[");
+        for (int t = 0; t < GAME_SIZE * GAME_SIZE; t++) {
+            if (t) buffer += ',';
+            putNumber(a.tile_words[t]);
+        }
+        put("],\"tile_points\":[");
+        for (int t = 0; t < GAME_SIZE * GAME_SIZE; t++) {
+            if (t) buffer += ',';
+            putNumber(a.tile_points[t]);
+        }
+        put("],\"unused\":[");
+        unsigned unused = a.unusedTiles();
+        for (int t = 0, first = 1; t < GAME_SIZE * GAME_SIZE; t++) {
+            if (!(unused & (1u << t))) continue;
+            if (!first) buffer += ',';
+            putNumber(t);
+            first = 0;
+        }
+        put("],\"bigrams\":[");
+        std::vector<std::pair<std::string, unsigned>> top = a.topBigrams(10);
+        for (size_t i = 0; i < top.size(); i++) {
+            if (i) buffer += ',';
+            buffer += '[';
+            putJsonString(top[i].first);
+            buffer += ',';
+            putNumber(top[i].second);
+            buffer += ']';
+        }
+        put("]}");
+    }
+    put("}\n");
+}
+
+void ResultWriter::writeCsv(const WordHunt& wh) {
+    if (!header_done) {
+        put(header(CSV));
+        header_done = true;
+    }
+    // boards come from stdin as they are, so fields are quoted if needed
+    std::map<int, std::vector<std::string>>::const_iterator it;
+    for (it = wh.m_vec.begin(); it != wh.m_vec.end(); ++it) {
+        for (const std::string& word : it->second) {
+            putCsvField(wh.board);
+            buffer += ',';
+            putNumber(it->first / GAME_SIZE);
+            buffer += ',';
+            putNumber(it->first % GAME_SIZE);
+            buffer += ',';
+            putCsvField(word);
+            buffer += ',';
+            putNumber(word.length());
+            buffer += ',';
+            putNumber(WordHunt::wordScore(word.length()));
+            buffer += ',';
+            putNumber(wh.lexiconsOf(word));
+            buffer += '\n';
+        }
+    }
+}
+
+void ResultWriter::writeBinary(const WordHunt& wh) {
+    putU8(wh.board.length());
+    put(wh.board);
+    putU32(wh.numWords());
+    putU32(wh.score());
+    unsigned kept = 0;
+    std::map<int, std::vector<std::string>>::const_iterator it;
+    for (it = wh.m_vec.begin(); it != wh.m_vec.end(); ++it) {
+        kept += it->second.size();
+    }
+    putU32(kept);
+    for (it = wh.m_vec.begin(); it != wh.m_vec.end(); ++it) {
+        for (const std::string& word : it->second) {
+            putU8(it->first);
+            putU8(word.length());
+            putU32(wh.lexiconsOf(word));
+            put(word);
+        }
+    }
+}
+
+// decimal digits without going through a locale-aware stream
+void ResultWriter::putNumber(unsigned long n) {
+    char digits[20];
+    int len = 0;
+    do {
+        digits[len++] = '0' + n % 10;
+        n /= 10;
+    } while (n);
+    while (len) buffer += digits[--len];
+}
+
+void ResultWriter::putJsonString(const std::string& s) {
+    static const char hex[] = "0123456789abcdef";
+    buffer += '"';
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            buffer += '\\';
+            buffer += c;
+        } else if ((unsigned char)c < 0x20) {
+            put("\\u00");
+            buffer += hex[(c >> 4) & 0xf];
+            buffer += hex[c & 0xf];
+        } else {
+            buffer += c;
+        }
+    }
+    buffer += '"';
+}
+
+// RFC 4180: a field holding a comma, quote or line break goes in quotes,
+// with its quotes doubled
+void ResultWriter::putCsvField(const std::string& s) {
+    if (s.find_first_of(",\"\r\n") == std::string::npos) {
+        put(s);
+        return;
+    }
+    buffer += '"';
+    for (char c : s) {
+        if (c == '"') buffer += '"';
+        buffer += c;
+    }
+    buffer += '"';
+}
+
+void ResultWriter::putU8(unsigned n) { buffer += (char)(n & 0xff); }
+
+void ResultWriter::putU32(unsigned n) {
+    for (int i = 0; i < 4; i++) buffer += (char)((n >> (8 * i)) & 0xff);
+}
@@ -0,0 +1,75 @@
+#ifndef __RESULTWRITER_H__
+#define __RESULTWRITER_H__
+
+#include <ostream>
+#include <string>
+
+#include "WordHunt.h"
+
+// writes solved boards to a stream in one of several formats. Output is
+// gathered in a buffer and handed to the stream in large chunks; nothing is
+// flushed until the buffer fills, flush() is called or the writer goes away.
+class ResultWriter {
+   public:
+    enum Format {
+        TEXT,   // "( r, c ) : words" per start tile, as displayResults
+        JSONL,  // one JSON object per board
+        CSV,    // one row per word, after a header row
+        BINARY  // length-prefixed little-endian records, see write()
+    };
+
+    explicit ResultWriter(std::ostream& os, Format format = TEXT,
+                          size_t buffer_size = 1 << 16);
+    ~ResultWriter();
+
+    ResultWriter(const ResultWriter&) = delete;
+    ResultWriter& operator=(const ResultWriter&) = delete;
+
+    // parse a format name ("text", "jsonl", "csv", "binary"), returns false
+    // and leaves format alone if the name is unknown.
+    static bool fromName(const std::string& name, Format& format);
+
+    // the text written once before the first board, e.g. the CSV column
+    // names; empty for the other formats.
+    static const char* header(Format format);
+
+    // don't write the header, the stream already has it (e.g. results
+    // merged from several writers).
+    void skipHeader() { header_done = true; }
+
+    // append the results of the last solve. Without kept words only the
+    // board, word count and score are written. With analytics on (see
+    // WordHunt::setAnalytics) TEXT adds per-tile grids, unused tiles and
+    // top bigrams, and JSONL an "analytics" object; CSV and BINARY leave
+    // them out.
+    //
+    // BINARY record, all integers little-endian:
+    //   u8 board length, board letters, u32 words, u32 score,
+    //   u32 words kept, then per kept word:
+    //   u8 start tile, u8 length, u32 lexicon mask, letters.
+    void write(const WordHunt& wh);
+
+    // hand everything buffered so far to the stream and flush it.
+    void flush();
+
+   private:
+    std::ostream& os;
+    Format format;
+    size_t buffer_size;
+    std::string buffer;
+    bool header_done;
+
+    void writeText(const WordHunt& wh);
+    void writeJson(const WordHunt& wh);
+    void writeCsv(const WordHunt& wh);
+    void writeBinary(const WordHunt& wh);
+
+    void put(const std::string& s) { buffer += s; }
+    void putNumber(unsigned long n);
+    void putJsonString(const std::string& s);
+    void putCsvField(const std::string& s);
+    void putU8(unsigned n);
+    void putU32(unsigned n);
+};
+
+#endif
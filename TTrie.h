@@ -5,8 +5,18 @@
 #include <vector>
 #include <string>
 #include <sstream>
-#include <map>
 
+#include "KeyTable.h"
+#include "TrieShape.h"
+
+/**
+ * Trie over sequences of DataType values. Each distinct value is interned
+ * once into a KeyTable shared by all the nodes of a trie, and nodes link to
+ * their children by the dense value ids, kept sorted in a vector; children
+ * with one of the first 64 ids are also flagged in a bitmap so they are
+ * found with a popcount instead of a search. DataType needs operator<
+ * and std::hash.
+ */
 template< typename DataType>
 class TTrie {
 public:
@@ -21,6 +31,12 @@ public:
    */
   TTrie(const TTrie& rhs);
 
+  /**
+   * Move Constructor.
+   * \param rhs The TTrie to take the nodes of, it is left empty.
+   */
+  TTrie(TTrie&& rhs);
+
   /**
    * Destructor.
    */
@@ -31,6 +47,11 @@ public:
    */
   TTrie& operator=(const TTrie<DataType> &rhs);
 
+  /**
+   * Move assignment operator, rhs is left empty.
+   */
+  TTrie& operator=(TTrie<DataType> &&rhs);
+
   /**
    * Overloaded addition/assignment operator to input a new vector into the TTrie.
    * \param sequence is the vector to insert into the trie
@@ -38,6 +59,22 @@ public:
    */
   TTrie& operator+=(const std::vector<DataType>& sequence);
 
+  /**
+   * Overloaded subtraction/assignment operator to remove a sequence, see
+   * remove.
+   * \param sequence is the sequence to remove
+   * \return a reference to the TTrie object
+   */
+  TTrie& operator-=(const std::vector<DataType>& sequence);
+
+  /**
+   * Remove a sequence, deleting the nodes that led only to it. Its values
+   * stay interned, so ids don't change.
+   * \param sequence is the sequence to remove
+   * \return true if the sequence was a member of the trie
+   */
+  bool remove(const std::vector<DataType>& sequence);
+
   /**
    * Overloaded carat operator to check whether a given sequence exists in the object.
    * \param sequence is the sequence to find
@@ -72,6 +109,13 @@ public:
    */
   unsigned numChildren() const;
 
+  /**
+   * Walk the trie and summarize its size and shape.
+   * \return node and endpoint counts, estimated heap bytes, and fan-out
+   *         and depth histograms
+   */
+  TrieShape shape() const;
+
   /**
    * \return true if there are any children, false otherwise
    */
@@ -99,9 +143,23 @@ public:
   bool isEndpoint() const; 
 
 private:
-    std::map<DataType, TTrie *> child;
+    struct Link {
+        unsigned id;
+        TTrie *node;
+    };
+    std::vector<Link> child;    // sorted by id
+    unsigned long long low;     // bit i set if there is a child with id i < 64
+    KeyTable<DataType> *keys;   // nullptr until the first insert
     bool isEnd;
-    void output_trie(std::ostream &os, std::stringstream& ss) const;
+    bool ownsKeys;              // true at the root, which deletes keys
+    explicit TTrie(KeyTable<DataType> *keys);
+    TTrie *find(unsigned id) const;
+    TTrie *add(unsigned id);
+    void unlink(unsigned id);
+    void clear();
+    void copy_trie(const TTrie<DataType>& rhs);
+    void swap(TTrie<DataType>& rhs);
+    void output_trie(std::ostream &os) const;
 };
 
 #include "TTrie.inc"
@@ -527,6 +527,175 @@ struct TTrieTest {
                         "spam-spam-spam-baked beans-spam\n");
   }
 
+  static void ShapeTest() {
+    ITrie it1;
+    std::vector<int> iseq1({8, 6, 7, 5, 3, 0, 9});
+    std::vector<int> iseq2({8, 6, 7, 101});
+    it1 += iseq1;
+    it1 += iseq2;
+
+    TrieShape ts = it1.shape();
+    ASSERT(ts.nodes == 9);
+    ASSERT(ts.endpoints == 2);
+    ASSERT(ts.fanout[2] == 1);
+    ASSERT(ts.depth.size() == 8);
+
+    STrie st1, st2;
+    std::vector<std::string> shortseq({"spam"});
+    std::vector<std::string> longseq({"a string too long to be stored inline"});
+    st1 += shortseq;
+    st2 += longseq;
+    ASSERT(st1.shape().nodes == st2.shape().nodes);
+    ASSERT(st1.shape().bytes < st2.shape().bytes);
+  }
+
+  static void MoveTest() {
+    STrie st1;
+    std::vector<std::string> sseq1({"rice", "beans"});
+    std::vector<std::string> sseq2({"quinoa", "mushrooms"});
+    st1 += sseq1;
+    STrie copy(st1);
+
+    STrie st2(std::move(st1));
+    ASSERT(st2 == copy);
+    ASSERT(st1.numChildren() == 0);
+    ASSERT(!(st1 ^ sseq1));
+
+    STrie st3;
+    st3 += sseq2;
+    st3 = std::move(st2);
+    ASSERT(st3 == copy);
+    ASSERT(!(st3 ^ sseq2));
+
+    std::vector<std::string> beans({"beans"});
+    st3 = *st3.getChild("rice");
+    ASSERT(st3 ^ beans);
+    ASSERT(!(st3 ^ sseq1));
+  }
+
+  static void LongSequenceTest() {
+    // deep enough to overflow the stack if any of these recursed per value
+    std::vector<int> iseq1;
+    for (int i = 0; i < 200000; i++) iseq1.push_back(i % 7);
+    std::vector<int> iseq2(iseq1.begin(), iseq1.end() - 1);
+    ITrie it1;
+    it1 += iseq1;
+    it1 += iseq2;
+
+    ITrie it2(it1);
+    ASSERT(it1 == it2);
+    ASSERT(it2 ^ iseq1);
+    ASSERT(it2 ^ iseq2);
+
+    std::stringstream ss;
+    ss << it2;
+    // n values print as 2n - 1 characters plus a newline
+    ASSERT(ss.str().length() == 2 * iseq1.size() + 2 * iseq2.size());
+
+    ITrie it3;
+    it3 = std::move(it2);
+    ASSERT(it3 == it1);
+    ASSERT(it3.shape().nodes == iseq1.size() + 1);
+  }
+
+  static void RemoveTest() {
+    ITrie it1, it2;
+    std::vector<int> iseq1({1, 2, 3});
+    std::vector<int> iseq2({1, 2});
+    std::vector<int> iseq3({1, 4, 5});
+    it1 += iseq1;
+    it1 += iseq2;
+    it1 += iseq3;
+    it2 += iseq2;
+    it2 += iseq3;
+    ASSERT(!it1.remove(std::vector<int>({1})));
+    ASSERT(!it1.remove(std::vector<int>({9})));
+    ASSERT(!it1.remove(std::vector<int>({1, 2, 3, 4})));
+    ASSERT(it1.remove(iseq1));
+    ASSERT(!(it1 ^ iseq1));
+    ASSERT(it1 ^ iseq2);
+    ASSERT(it1 == it2);
+    ASSERT(it1.shape().nodes == 5);
+    ASSERT(!it1.remove(iseq1));
+
+    // the whole branch goes once nothing ends below it
+    it1 -= iseq3;
+    ASSERT(it1.shape().nodes == 3);
+    ASSERT(it1.getChild(1)->numChildren() == 1);
+    it1 -= iseq2;
+    ASSERT(it1.numChildren() == 0);
+    ASSERT(it1 == ITrie());
+    it1 += iseq3;
+    ASSERT(it1 ^ iseq3);
+
+    // children past the bitmap, and unlinking keeps the rest findable
+    ITrie it3;
+    for (int i = 0; i < 100; i++) it3 += std::vector<int>({i * 3});
+    for (int i = 0; i < 100; i += 2) it3 -= std::vector<int>({i * 3});
+    ASSERT(it3.numChildren() == 50);
+    bool all = true;
+    for (int i = 0; i < 100; i++) all = all && (it3.hasChild(i * 3) == (i % 2 == 1));
+    ASSERT(all);
+    std::stringstream ss;
+    ss << it3;
+    ASSERT(ss.str().compare(0, 6, "3\n9\n15") == 0);
+
+    STrie st;
+    std::vector<std::string> sseq({"x", "y"});
+    st += sseq;
+    ASSERT(st.remove(sseq) && !st.hasChild());
+  }
+
+  static void InternTest() {
+    // values far apart and out of order, and more distinct values than fit
+    // the bitmap of a node
+    ITrie it1, it2;
+    std::vector<std::vector<int> > seqs;
+    for (int i = 0; i < 100; i++) {
+      seqs.push_back(std::vector<int>({(i * 37 % 100 - 50) * 1000003, i}));
+    }
+    for (unsigned i = 0; i < seqs.size(); i++) it1 += seqs[i];
+    for (unsigned i = seqs.size(); i-- > 0;) it2 += seqs[i];
+    ASSERT(it1.numChildren() == 100);
+    ASSERT(it1 == it2);
+    ASSERT(it2 == it1);
+    bool all = true;
+    for (unsigned i = 0; i < seqs.size(); i++) all = all && (it2 ^ seqs[i]) && it1.hasChild(seqs[i][0]);
+    ASSERT(all);
+    ASSERT(!it1.hasChild(1));
+    ASSERT(!(it1 ^ std::vector<int>({-50 * 1000003, 1})));
+
+    std::stringstream ss1, ss2;
+    ss1 << it1;
+    ss2 << it2;
+    ASSERT(ss1.str() == ss2.str());
+    ASSERT(ss1.str().compare(0, 16, "-50000150-0\n-490") == 0);
+
+    // a value only in it2 makes them differ, even though each id is used
+    std::vector<int> extra({7});
+    it2 += extra;
+    ASSERT(!(it1 == it2));
+    it1 += extra;
+    ASSERT(it1 == it2);
+
+    // a copied subtrie keeps working with its own table
+    STrie st1;
+    std::vector<std::string> sseq1({"b", "c"});
+    std::vector<std::string> sseq2({"b", "a"});
+    st1 += sseq1;
+    st1 += sseq2;
+    STrie st2(*st1.getChild("b"));
+    std::vector<std::string> a({"a"});
+    ASSERT(st2 ^ a);
+    std::stringstream ss3;
+    ss3 << st2;
+    ASSERT(ss3.str() == "a\nc\n");
+    STrie st3;
+    st3 += std::vector<std::string>({"c"});
+    st3 += a;
+    ASSERT(st3 == st2);
+  }
+
 };
 
 int main(int, char* argv[]) {
@@ -547,4 +716,9 @@ int main(int, char* argv[]) {
   TTrieTest::ChainingTest();
   TTrieTest::EqualityOperatorTest();
   TTrieTest::OutputStreamOperatorTest();
+  TTrieTest::ShapeTest();
+  TTrieTest::MoveTest();
+  TTrieTest::LongSequenceTest();
+  TTrieTest::InternTest();
+  TTrieTest::RemoveTest();
 }
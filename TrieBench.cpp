@@ -0,0 +1,408 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "CTrie.h"
+#include "Completer.h"
+#include "FlatTrie.h"
+#include "TTrie.h"
+#include "WordSet.h"
+
+using std::cout;
+using std::endl;
+using namespace std::chrono;
+
+// Microbenchmarks for the trie primitives. Every (trie, operation, key
+// distribution, size) case is timed `reps` times after a warm-up run and
+// printed as one CSV row of nanoseconds per operation, e.g.
+//   trie,op,dist,size,reps,median_ns,min_ns,mean_ns,stddev_ns
+//   CTrie,insert,words,10000,7,412.3,398.1,415.0,9.6
+
+namespace {
+
+// settings, see parseArgs
+unsigned reps = 7;
+std::vector<unsigned> sizes = {1000, 10000, 100000};
+std::string word_file = "words.txt";
+
+// keep results alive so the optimizer can't drop the timed work
+volatile unsigned long sink;
+
+// key conversions: CTrie takes the word itself, TTrie<char> its letters,
+// TTrie<int> letters spread over a wide sparse domain, and
+// TTrie<std::string> two-letter syllables.
+struct CharKeys {
+    typedef std::vector<char> Key;
+    static Key convert(const std::string& w) { return Key(w.begin(), w.end()); }
+};
+
+struct IntKeys {
+    typedef std::vector<int> Key;
+    static Key convert(const std::string& w) {
+        Key key;
+        for (unsigned i = 0; i < w.length(); i++) key.push_back(w[i] * 1000003);
+        return key;
+    }
+};
+
+struct StringKeys {
+    typedef std::vector<std::string> Key;
+    static Key convert(const std::string& w) {
+        Key key;
+        for (unsigned i = 0; i < w.length(); i += 2) key.push_back(w.substr(i, 2));
+        return key;
+    }
+};
+
+struct WordKeys {
+    typedef std::string Key;
+    static Key convert(const std::string& w) { return w; }
+};
+
+// key distributions
+std::vector<std::string> sampleWords(const std::vector<std::string>& all,
+                                     unsigned n, std::mt19937& rng) {
+    std::vector<std::string> out;
+    for (unsigned i = 0; i < n; i++) out.push_back(all[rng() % all.size()]);
+    return out;
+}
+
+std::vector<std::string> randomWords(unsigned n, std::mt19937& rng) {
+    std::vector<std::string> out;
+    for (unsigned i = 0; i < n; i++) {
+        std::string w(3 + rng() % 10, 'a');
+        for (unsigned j = 0; j < w.length(); j++) w[j] = 'a' + rng() % 26;
+        out.push_back(w);
+    }
+    return out;
+}
+
+// long shared prefixes: deep, narrow tries
+std::vector<std::string> prefixWords(unsigned n, std::mt19937& rng) {
+    std::vector<std::string> out;
+    for (unsigned i = 0; i < n; i++) {
+        std::string w = "internationalization";
+        w.resize(8 + rng() % 12);
+        for (unsigned j = 0; j < 4; j++) w.push_back('a' + rng() % 4);
+        out.push_back(w);
+    }
+    return out;
+}
+
+struct Summary {
+    double median, min, mean, stddev;
+};
+
+Summary summarize(std::vector<double> ns) {
+    Summary s;
+    std::sort(ns.begin(), ns.end());
+    s.median = ns[ns.size() / 2];
+    s.min = ns[0];
+    s.mean = 0;
+    for (unsigned i = 0; i < ns.size(); i++) s.mean += ns[i];
+    s.mean /= ns.size();
+    s.stddev = 0;
+    for (unsigned i = 0; i < ns.size(); i++) {
+        s.stddev += (ns[i] - s.mean) * (ns[i] - s.mean);
+    }
+    s.stddev = std::sqrt(s.stddev / ns.size());
+    return s;
+}
+
+void report(const std::string& trie, const std::string& op,
+            const std::string& dist, unsigned size,
+            const std::vector<double>& ns) {
+    Summary s = summarize(ns);
+    cout << trie << "," << op << "," << dist << "," << size << ","
+         << ns.size() << "," << s.median << "," << s.min << "," << s.mean
+         << "," << s.stddev << "\n";
+}
+
+double nsPerOp(steady_clock::time_point start, steady_clock::time_point stop,
+               unsigned long ops) {
+    return duration_cast<nanoseconds>(stop - start).count() /
+           (double)(ops ? ops : 1);
+}
+
+// time every primitive for one trie type on one key set.
+template <typename Trie, typename Keys>
+void benchTrie(const std::string& name, const std::string& dist,
+               const std::vector<std::string>& words) {
+    typedef typename Keys::Key Key;
+    std::vector<Key> keys;
+    for (unsigned i = 0; i < words.size(); i++) {
+        keys.push_back(Keys::convert(words[i]));
+    }
+    std::vector<Key> misses;
+    for (unsigned i = 0; i < words.size(); i++) {
+        misses.push_back(Keys::convert(words[i] + "q"));
+    }
+    std::vector<double> insert, lookup, miss, walk, equal, copy, destroy,
+        output;
+
+    // one extra warm-up repetition, dropped before reporting
+    for (unsigned r = 0; r <= reps; r++) {
+        Trie trie;
+        auto start = steady_clock::now();
+        for (unsigned i = 0; i < keys.size(); i++) trie += keys[i];
+        insert.push_back(nsPerOp(start, steady_clock::now(), keys.size()));
+
+        unsigned long found = 0;
+        start = steady_clock::now();
+        for (unsigned i = 0; i < keys.size(); i++) found += trie ^ keys[i];
+        lookup.push_back(nsPerOp(start, steady_clock::now(), keys.size()));
+
+        start = steady_clock::now();
+        for (unsigned i = 0; i < misses.size(); i++) found += trie ^ misses[i];
+        miss.push_back(nsPerOp(start, steady_clock::now(), misses.size()));
+
+        // hasChild/getChild per step, the way the board search uses them
+        unsigned long steps = 0;
+        start = steady_clock::now();
+        for (unsigned i = 0; i < keys.size(); i++) {
+            const Trie* node = &trie;
+            for (unsigned j = 0; j < keys[i].size() && node; j++, steps++) {
+                if (!node->hasChild(keys[i][j])) break;
+                node = node->getChild(keys[i][j]);
+            }
+            found += node != nullptr;
+        }
+        walk.push_back(nsPerOp(start, steady_clock::now(), steps));
+
+        start = steady_clock::now();
+        Trie* clone = new Trie(trie);
+        copy.push_back(nsPerOp(start, steady_clock::now(), keys.size()));
+
+        start = steady_clock::now();
+        found += *clone == trie;
+        equal.push_back(nsPerOp(start, steady_clock::now(), keys.size()));
+
+        start = steady_clock::now();
+        delete clone;
+        destroy.push_back(nsPerOp(start, steady_clock::now(), keys.size()));
+
+        std::stringstream ss;
+        start = steady_clock::now();
+        ss << trie;
+        output.push_back(nsPerOp(start, steady_clock::now(), keys.size()));
+        sink = found + ss.str().length();
+    }
+    std::vector<double>* all[] = {&insert, &lookup, &miss, &walk,
+                                  &equal, &copy, &destroy, &output};
+    for (unsigned i = 0; i < sizeof(all) / sizeof(all[0]); i++) {
+        all[i]->erase(all[i]->begin());
+    }
+    report(name, "insert", dist, words.size(), insert);
+    report(name, "lookup_hit", dist, words.size(), lookup);
+    report(name, "lookup_miss", dist, words.size(), miss);
+    report(name, "child_step", dist, words.size(), walk);
+    report(name, "copy", dist, words.size(), copy);
+    report(name, "equal", dist, words.size(), equal);
+    report(name, "destroy", dist, words.size(), destroy);
+    report(name, "output", dist, words.size(), output);
+}
+
+// exact membership checks: the hash set index against walking a flattened
+// trie (CTrie's own lookups are timed by benchTrie), and CTrie lookups one
+// by one against lookupAll on the same mixed batch.
+void benchMembership(const std::string& dist,
+                     const std::vector<std::string>& words) {
+    std::vector<std::string> misses;
+    for (unsigned i = 0; i < words.size(); i++) misses.push_back(words[i] + "q");
+    CTrie ct;
+    for (unsigned i = 0; i < words.size(); i++) ct += words[i];
+    FlatTrie flat(ct);
+    // half hits and half misses, shuffled, answered as one batch
+    std::vector<std::string> batch(words);
+    batch.insert(batch.end(), misses.begin(), misses.end());
+    std::shuffle(batch.begin(), batch.end(), std::mt19937(7));
+    std::vector<double> insert, set_hit, set_miss, flat_hit, flat_miss, single,
+        batched;
+
+    // one extra warm-up repetition, dropped before reporting
+    for (unsigned r = 0; r <= reps; r++) {
+        WordSet set;
+        auto start = steady_clock::now();
+        for (unsigned i = 0; i < words.size(); i++) set.insert(words[i], 1u);
+        insert.push_back(nsPerOp(start, steady_clock::now(), words.size()));
+
+        unsigned long found = 0;
+        start = steady_clock::now();
+        for (unsigned i = 0; i < words.size(); i++) found += set.contains(words[i]);
+        set_hit.push_back(nsPerOp(start, steady_clock::now(), words.size()));
+
+        start = steady_clock::now();
+        for (unsigned i = 0; i < misses.size(); i++) found += set.contains(misses[i]);
+        set_miss.push_back(nsPerOp(start, steady_clock::now(), misses.size()));
+
+        start = steady_clock::now();
+        for (unsigned i = 0; i < words.size(); i++) found += flat.lookup(words[i]);
+        flat_hit.push_back(nsPerOp(start, steady_clock::now(), words.size()));
+
+        start = steady_clock::now();
+        for (unsigned i = 0; i < misses.size(); i++) found += flat.lookup(misses[i]);
+        flat_miss.push_back(nsPerOp(start, steady_clock::now(), misses.size()));
+
+        start = steady_clock::now();
+        for (unsigned i = 0; i < batch.size(); i++) found += ct.lookup(batch[i]);
+        single.push_back(nsPerOp(start, steady_clock::now(), batch.size()));
+
+        start = steady_clock::now();
+        std::vector<unsigned> masks = ct.lookupAll(batch);
+        batched.push_back(nsPerOp(start, steady_clock::now(), batch.size()));
+        sink = found + set.bytes() + masks.size();
+    }
+    std::vector<double>* all[] = {&insert, &set_hit, &set_miss, &flat_hit,
+                                  &flat_miss, &single, &batched};
+    for (unsigned i = 0; i < sizeof(all) / sizeof(all[0]); i++) {
+        all[i]->erase(all[i]->begin());
+    }
+    report("WordSet", "insert", dist, words.size(), insert);
+    report("WordSet", "lookup_hit", dist, words.size(), set_hit);
+    report("WordSet", "lookup_miss", dist, words.size(), set_miss);
+    report("FlatTrie", "lookup_hit", dist, words.size(), flat_hit);
+    report("FlatTrie", "lookup_miss", dist, words.size(), flat_miss);
+    report("CTrie", "lookup_mixed", dist, words.size(), single);
+    report("CTrie", "lookup_batch", dist, words.size(), batched);
+}
+
+// top 10 completions of 2 and 3 letter prefixes: the Completer's cached
+// lists against walking the CTrie subtree below the prefix and ranking it.
+void benchCompletion(const std::string& dist,
+                     const std::vector<std::string>& words) {
+    // heavy tailed frequencies, the same for every repetition
+    std::mt19937 rng(11);
+    std::vector<std::pair<std::string, unsigned long> > counts;
+    std::unordered_map<std::string, unsigned long> weight;
+    CTrie ct;
+    for (unsigned i = 0; i < words.size(); i++) {
+        unsigned long c = 1000000 / (1 + rng() % words.size());
+        counts.push_back(std::make_pair(words[i], c));
+        weight[words[i]] += c;
+        ct += words[i];
+    }
+    std::vector<std::string> prefixes;
+    for (unsigned i = 0; i < words.size(); i++) {
+        prefixes.push_back(words[i].substr(0, 2 + i % 2));
+    }
+    std::vector<double> build, cached, walk;
+
+    // one extra warm-up repetition, dropped before reporting
+    for (unsigned r = 0; r <= reps; r++) {
+        auto start = steady_clock::now();
+        Completer completer(counts, 10);
+        build.push_back(nsPerOp(start, steady_clock::now(), words.size()));
+
+        unsigned long found = 0;
+        start = steady_clock::now();
+        for (unsigned i = 0; i < prefixes.size(); i++) {
+            found += completer.complete(prefixes[i], 10).size();
+        }
+        cached.push_back(nsPerOp(start, steady_clock::now(), prefixes.size()));
+
+        // the walk is much slower, time a sample of the prefixes
+        unsigned n = std::min<unsigned long>(prefixes.size(), 1000);
+        start = steady_clock::now();
+        for (unsigned i = 0; i < n; i++) {
+            const CTrie* node = &ct;
+            for (unsigned j = 0; j < prefixes[i].length() && node; j++) {
+                node = node->getChild(prefixes[i][j]);
+            }
+            if (!node) continue;
+            std::stringstream ss;
+            ss << *node;
+            std::vector<std::pair<unsigned long, std::string> > ranked;
+            std::string suffix;
+            while (ss >> suffix) {
+                std::string w = prefixes[i] + suffix;
+                ranked.push_back(std::make_pair(~weight[w], w));
+            }
+            if (node->isEndpoint()) {
+                ranked.push_back(std::make_pair(~weight[prefixes[i]], prefixes[i]));
+            }
+            unsigned keep = std::min<unsigned long>(10, ranked.size());
+            std::partial_sort(ranked.begin(), ranked.begin() + keep, ranked.end());
+            found += keep;
+        }
+        walk.push_back(nsPerOp(start, steady_clock::now(), n));
+        sink = found + completer.bytes();
+    }
+    std::vector<double>* all[] = {&build, &cached, &walk};
+    for (unsigned i = 0; i < sizeof(all) / sizeof(all[0]); i++) {
+        all[i]->erase(all[i]->begin());
+    }
+    report("Completer", "build", dist, words.size(), build);
+    report("Completer", "complete_top10", dist, words.size(), cached);
+    report("CTrie", "complete_walk", dist, words.size(), walk);
+}
+
+// comma separated list of numbers
+std::vector<unsigned> parseList(const char* value) {
+    std::vector<unsigned> out;
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        out.push_back(std::strtoul(item.c_str(), nullptr, 10));
+    }
+    return out;
+}
+
+void parseArgs(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 7, "--reps=") == 0) {
+            reps = std::strtoul(arg.c_str() + 7, nullptr, 10);
+        } else if (arg.compare(0, 8, "--sizes=") == 0) {
+            sizes = parseList(arg.c_str() + 8);
+        } else if (arg.compare(0, 8, "--words=") == 0) {
+            word_file = arg.substr(8);
+        }
+    }
+    if (reps == 0) reps = 1;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    parseArgs(argc, argv);
+    std::vector<std::string> all;
+    std::ifstream file(word_file);
+    std::string word;
+    while (file >> word) all.push_back(word);
+    if (all.empty()) {
+        std::cerr << "no words in " << word_file << endl;
+        return 1;
+    }
+
+    cout << "trie,op,dist,size,reps,median_ns,min_ns,mean_ns,stddev_ns\n";
+    for (unsigned s = 0; s < sizes.size(); s++) {
+        // the same seed for every size keeps runs comparable
+        std::mt19937 rng(42);
+        std::vector<std::pair<std::string, std::vector<std::string> > > sets;
+        sets.push_back(std::make_pair("words", sampleWords(all, sizes[s], rng)));
+        sets.push_back(std::make_pair("random", randomWords(sizes[s], rng)));
+        sets.push_back(std::make_pair("prefix", prefixWords(sizes[s], rng)));
+
+        for (unsigned d = 0; d < sets.size(); d++) {
+            benchTrie<CTrie, WordKeys>("CTrie", sets[d].first, sets[d].second);
+            benchTrie<TTrie<char>, CharKeys>("TTrie<char>", sets[d].first,
+                                             sets[d].second);
+            benchTrie<TTrie<int>, IntKeys>("TTrie<int>", sets[d].first,
+                                           sets[d].second);
+            benchTrie<TTrie<std::string>, StringKeys>(
+                "TTrie<string>", sets[d].first, sets[d].second);
+            benchMembership(sets[d].first, sets[d].second);
+            benchCompletion(sets[d].first, sets[d].second);
+        }
+        cout.flush();
+    }
+    return 0;
+}
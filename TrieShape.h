@@ -0,0 +1,88 @@
+#ifndef TRIESHAPE_H
+#define TRIESHAPE_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * Size and shape summary of a trie, filled in by CTrie::shape(),
+ * TTrie::shape() and RTrie::shape().
+ */
+struct TrieShape {
+  unsigned long nodes;
+  unsigned long endpoints;
+  /** estimated heap bytes, including malloc chunk overhead */
+  unsigned long bytes;
+  /** fanout[k] is the number of nodes with k children */
+  std::vector<unsigned long> fanout;
+  /** depth[d] is the number of nodes d links below the root */
+  std::vector<unsigned long> depth;
+
+  TrieShape() : nodes(0), endpoints(0), bytes(0) {}
+
+  /**
+   * Count one node.
+   * \param children the node's number of children
+   * \param level the node's depth
+   * \param endpoint whether the node ends a word
+   */
+  void addNode(unsigned long children, unsigned long level, bool endpoint) {
+    nodes++;
+    if (endpoint) endpoints++;
+    if (fanout.size() <= children) fanout.resize(children + 1, 0);
+    fanout[children]++;
+    if (depth.size() <= level) depth.resize(level + 1, 0);
+    depth[level]++;
+  }
+
+  /**
+   * Estimate what a heap allocation really costs with glibc malloc: an
+   * 8 byte header, rounded up to 16 bytes, at least 32 bytes.
+   * \param size the requested size
+   * \return the size of the chunk malloc hands out
+   */
+  static unsigned long heapBytes(unsigned long size) {
+    unsigned long chunk = (size + 8 + 15) & ~15ul;
+    return chunk < 32 ? 32 : chunk;
+  }
+
+  /**
+   * Estimate the heap cost of one std::map entry holding value_size bytes
+   * (red-black tree node header plus the key/value pair).
+   */
+  static unsigned long mapEntryBytes(unsigned long value_size) {
+    return heapBytes(4 * sizeof(void*) + value_size);
+  }
+
+  /** Heap bytes owned by a key, beyond the key itself. */
+  template <typename T>
+  static unsigned long keyBytes(const T&) { return 0; }
+
+  static unsigned long keyBytes(const std::string& key) {
+    //short strings live inside the std::string object itself
+    return key.capacity() > 15 ? heapBytes(key.capacity() + 1) : 0;
+  }
+};
+
+/**
+ * Print a TrieShape as "name: value" lines, histograms as "key:count" pairs.
+ */
+inline std::ostream& operator<<(std::ostream& os, const TrieShape& ts) {
+  os << "nodes: " << ts.nodes << "\n";
+  os << "endpoints: " << ts.endpoints << "\n";
+  os << "bytes: " << ts.bytes;
+  if (ts.nodes) os << " (" << ts.bytes / ts.nodes << " per node)";
+  os << "\nfan-out:";
+  for (unsigned i = 0; i < ts.fanout.size(); i++) {
+    if (ts.fanout[i]) os << " " << i << ":" << ts.fanout[i];
+  }
+  os << "\ndepth:";
+  for (unsigned i = 0; i < ts.depth.size(); i++) {
+    if (ts.depth[i]) os << " " << i << ":" << ts.depth[i];
+  }
+  os << "\n";
+  return os;
+}
+
+#endif // TRIESHAPE_H
@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <sstream>
+
+#include "WordDelta.h"
+
+//queue a word to add
+void WordDelta::add(const std::string& word, unsigned lexicon) {
+    Change c = {word, lexicon};
+    added.push_back(c);
+}
+
+//queue a word to remove
+void WordDelta::remove(const std::string& word, unsigned lexicon) {
+    Change c = {word, lexicon};
+    removed.push_back(c);
+}
+
+//removals, then additions that weren't already in their lexicon
+unsigned long WordDelta::applyTo(CTrie& ct) const {
+    unsigned long changed = 0;
+    for (unsigned long i = 0; i < removed.size(); i++) {
+        if (ct.remove(removed[i].word, 1u << removed[i].lexicon)) changed++;
+    }
+    for (unsigned long i = 0; i < added.size(); i++) {
+        unsigned bit = 1u << added[i].lexicon;
+        if (ct.lookup(added[i].word) & bit) continue;
+        ct.insert(added[i].word, bit);
+        changed++;
+    }
+    return changed;
+}
+
+//only removals fit in the existing nodes
+bool WordDelta::applyTo(FlatTrie& ft) const {
+    if (!added.empty() || !ft.ownsNodes()) return false;
+    for (unsigned long i = 0; i < removed.size(); i++) {
+        ft.remove(removed[i].word, 1u << removed[i].lexicon);
+    }
+    return true;
+}
+
+//sorted, deduplicated words of a list
+static std::vector<std::string> readWords(std::istream& in) {
+    std::vector<std::string> words;
+    std::string word;
+    while (in >> word) words.push_back(word);
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+    return words;
+}
+
+//merge the two sorted lists, words on only one side are the changes
+WordDelta WordDelta::diff(std::istream& before, std::istream& after, unsigned lexicon) {
+    std::vector<std::string> old_words = readWords(before), new_words = readWords(after);
+    WordDelta delta;
+    std::vector<std::string>::const_iterator i = old_words.begin(), j = new_words.begin();
+    while (i != old_words.end() || j != new_words.end()) {
+        if (j == new_words.end() || (i != old_words.end() && *i < *j)) {
+            delta.remove(*i++, lexicon);
+        } else if (i == old_words.end() || *j < *i) {
+            delta.add(*j++, lexicon);
+        } else {
+            i++;
+            j++;
+        }
+    }
+    return delta;
+}
+
+//"+word [lexicon]" and "-word [lexicon]" lines
+WordDelta WordDelta::read(std::istream& in, unsigned long* malformed) {
+    WordDelta delta;
+    unsigned long bad = 0;
+    std::string line, word, field;
+    while (std::getline(in, line)) {
+        std::istringstream ss(line);
+        if (!(ss >> word) || word[0] == '#') continue;
+        if (word.length() < 2 || (word[0] != '+' && word[0] != '-')) {
+            bad++;
+            continue;
+        }
+        //a lexicon field that is there has to be one, not fall back to 0
+        unsigned lexicon = 0;
+        if (ss >> field) {
+            if (field.length() > 2 || field.find_first_not_of("0123456789") != std::string::npos ||
+                (lexicon = std::stoul(field)) > 31) {
+                bad++;
+                continue;
+            }
+        }
+        if (word[0] == '+') {
+            delta.add(word.substr(1), lexicon);
+        } else {
+            delta.remove(word.substr(1), lexicon);
+        }
+    }
+    if (malformed) *malformed = bad;
+    return delta;
+}
+
+//removals first, the order they are applied in
+void WordDelta::write(std::ostream& os) const {
+    for (unsigned long i = 0; i < removed.size(); i++) {
+        os << '-' << removed[i].word;
+        if (removed[i].lexicon) os << ' ' << removed[i].lexicon;
+        os << '\n';
+    }
+    for (unsigned long i = 0; i < added.size(); i++) {
+        os << '+' << added[i].word;
+        if (added[i].lexicon) os << ' ' << added[i].lexicon;
+        os << '\n';
+    }
+}
@@ -0,0 +1,100 @@
+#ifndef WORDDELTA_H
+#define WORDDELTA_H
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "CTrie.h"
+#include "FlatTrie.h"
+
+/**
+ * A change to a dictionary: words to remove and words to add, each for one
+ * lexicon. Applying it to a trie takes time in the size of the change, not
+ * of the dictionary. As text it is one change per line, "+word" or
+ * "-word", optionally followed by whitespace and the lexicon (0-31,
+ * default 0 when there is none); blank lines and lines starting with '#'
+ * are skipped.
+ */
+class WordDelta {
+public:
+  /** one word added to or removed from one lexicon */
+  struct Change {
+    std::string word;
+    unsigned lexicon;
+  };
+
+  /**
+   * Add a word to the delta's additions.
+   * \param word the word
+   * \param lexicon the lexicon (0-31) it goes into
+   */
+  void add(const std::string &word, unsigned lexicon = 0);
+
+  /**
+   * Add a word to the delta's removals.
+   * \param word the word
+   * \param lexicon the lexicon (0-31) it is removed from
+   */
+  void remove(const std::string &word, unsigned lexicon = 0);
+
+  /**
+   * \return the words added and the words removed, in the order given
+   */
+  const std::vector<Change> &additions() const { return added; }
+  const std::vector<Change> &removals() const { return removed; }
+
+  /**
+   * \return the number of changes
+   */
+  unsigned long size() const { return added.size() + removed.size(); }
+
+  /**
+   * Apply the delta in place: removals first, then additions, so a word
+   * both removed and added ends up present.
+   * \param ct the trie to change
+   * \return the number of changes that did anything, i.e. the removed
+   *         words that were there and the added words that weren't
+   */
+  unsigned long applyTo(CTrie &ct) const;
+
+  /**
+   * Apply a delta of removals only to a FlatTrie's nodes in place, see
+   * FlatTrie::remove.
+   * \param ft the flattened trie to change
+   * \return false, changing nothing, if the delta adds any word or ft is
+   *         a view; the trie has to be rebuilt from a CTrie then
+   */
+  bool applyTo(FlatTrie &ft) const;
+
+  /**
+   * The changes that turn one word list into another, in sorted order.
+   * Lists are read as whitespace separated words, like
+   * Dictionary::load_file.
+   * \param before the old word list
+   * \param after the new word list
+   * \param lexicon the lexicon both lists are loaded into
+   * \return the delta from before to after
+   */
+  static WordDelta diff(std::istream &before, std::istream &after, unsigned lexicon = 0);
+
+  /**
+   * \param in the text form of a delta
+   * \param malformed if given, set to the number of lines skipped because
+   *        they aren't a change or their lexicon isn't a number in 0-31
+   * \return the delta of the well-formed lines
+   */
+  static WordDelta read(std::istream &in, unsigned long *malformed = nullptr);
+
+  /**
+   * \param os the stream to write the text form to, removals first
+   */
+  void write(std::ostream &os) const;
+
+private:
+  std::vector<Change> added;
+  std::vector<Change> removed;
+};
+
+#endif
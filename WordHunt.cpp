@@ -2,112 +2,614 @@
 
 #include <assert.h>
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <iterator>
 #include <vector>
 
-WordHunt::WordHunt() : trie(new CTrie()) {}
+#include "Lockstep.h"
+#include "PathAutomaton.h"
+#include "ResultWriter.h"
 
-WordHunt::WordHunt(const WordHunt& rhs) : trie(new CTrie(*rhs.trie)) {}
+// the board's move table, looked up once.
+namespace {
+const PathAutomaton& moves() {
+    static const PathAutomaton& table =
+        PathAutomaton::forGeometry(GAME_SIZE, GAME_SIZE);
+    return table;
+}
+}  // namespace
+
+WordHunt::WordHunt()
+    : dict(std::make_shared<Dictionary>()),
+      engine(TRIE_DFS),
+      keep_words(true),
+      min_length(0),
+      max_length(~0u),
+      num_words(0),
+      total_score(0),
+      gather(false),
+      budget_us(0),
+      budget_nodes(0) {}
+
+WordHunt::WordHunt(std::shared_ptr<const Dictionary> dict)
+    : dict(dict),
+      engine(TRIE_DFS),
+      keep_words(true),
+      min_length(0),
+      max_length(~0u),
+      num_words(0),
+      total_score(0),
+      gather(false),
+      budget_us(0),
+      budget_nodes(0) {}
+
+WordHunt::WordHunt(const WordHunt& rhs)
+    : dict(rhs.dict),
+      store(rhs.store),
+      engine(rhs.engine),
+      keep_words(rhs.keep_words),
+      min_length(rhs.min_length),
+      max_length(rhs.max_length),
+      num_words(0),
+      total_score(0),
+      gather(rhs.gather),
+      budget_us(rhs.budget_us),
+      budget_nodes(rhs.budget_nodes) {}
 
-WordHunt::~WordHunt() { if (trie) delete trie; }
+WordHunt::~WordHunt() {}
 
 WordHunt& WordHunt::operator=(const WordHunt& rhs) {
   if (this != &rhs) {
-    if (trie) delete trie;
-    trie = new CTrie(*rhs.trie);
+    dict = rhs.dict;
+    store = rhs.store;
+    engine = rhs.engine;
+    keep_words = rhs.keep_words;
+    min_length = rhs.min_length;
+    max_length = rhs.max_length;
+    gather = rhs.gather;
+    budget_us = rhs.budget_us;
+    budget_nodes = rhs.budget_nodes;
   }
   return *this;
 }
 
-// load the file
-void WordHunt::load_file(std::string filename) {
-    std::ifstream file(filename);
+// pick the search engine
+void WordHunt::setEngine(Engine e) { engine = e; }
 
-    std::string word;
-    while (file >> word) {
-        *trie += word;
-    }
+WordHunt::Engine WordHunt::getEngine() const { return engine; }
+
+// shape of the dictionary trie
+TrieShape WordHunt::shape() const {
+    if (dict->flat()) return dict->flat()->shape();
+    return dict->trie().shape();
+}
+
+// load the file into a new copy of the dictionary, anyone else sharing the
+// current one keeps it as it is.
+bool WordHunt::load_file(std::string filename, unsigned lexicon) {
+    if (dict->flat()) return false;
+    // a dictionary no one else holds grows in place, a shared one is copied
+    std::shared_ptr<Dictionary> next =
+        dict.use_count() == 1 ? std::const_pointer_cast<Dictionary>(dict)
+                              : std::make_shared<Dictionary>(*dict);
+    next->setWordLengths(min_length, max_length);
+    if (!next->load_file(filename, lexicon)) return false;
+    dict = next;
+    return true;
+}
+
+std::shared_ptr<const Dictionary> WordHunt::dictionary() const { return dict; }
+
+// search a different dictionary from now on
+void WordHunt::setDictionary(std::shared_ptr<const Dictionary> dict) {
+    this->dict = dict;
 }
 
 // set the board string to the object
 void WordHunt::setBoard(std::string& brd) {
-    assert(brd.length() == 16);
+    assert(brd.length() == GAME_SIZE * GAME_SIZE);
 
     this->board = brd;
+    m_vec.clear();
+    words_found.clear();
+    found_nodes.clear();
+    num_words = 0;
+    total_score = 0;
+    if (gather) {
+        stats = Analytics();
+        tile_masks.clear();
+    }
+}
+
+// keep or drop the found words
+void WordHunt::setKeepWords(bool keep) { keep_words = keep; }
+
+// gather per-tile statistics or not
+void WordHunt::setAnalytics(bool enable) {
+    gather = enable;
+    stats = Analytics();
+    tile_masks.clear();
+}
+
+const WordHunt::Analytics& WordHunt::analytics() const { return stats; }
+
+unsigned WordHunt::Analytics::unusedTiles() const {
+    return ((1u << (GAME_SIZE * GAME_SIZE)) - 1) & ~used_tiles;
+}
+
+// rank the non-zero pairs, ties in alphabetical order
+std::vector<std::pair<std::string, unsigned>> WordHunt::Analytics::topBigrams(
+    unsigned n) const {
+    std::vector<std::pair<std::string, unsigned>> pairs;
+    for (int a = 0; a < 26; a++) {
+        for (int b = 0; b < 26; b++) {
+            if (!bigrams[a][b]) continue;
+            std::string pair;
+            pair += 'a' + a;
+            pair += 'a' + b;
+            pairs.push_back(std::make_pair(pair, bigrams[a][b]));
+        }
+    }
+    std::stable_sort(pairs.begin(), pairs.end(),
+                     [](const std::pair<std::string, unsigned>& x,
+                        const std::pair<std::string, unsigned>& y) {
+                         return x.second > y.second;
+                     });
+    if (pairs.size() > n) pairs.resize(n);
+    return pairs;
+}
+
+// follow a store's reloads
+void WordHunt::follow(std::shared_ptr<const DictionaryStore> store) {
+    this->store = store;
+    if (store) dict = store->current();
+}
+
+// limits for later solves
+void WordHunt::setBudget(unsigned long time_us, unsigned long nodes) {
+    budget_us = time_us;
+    budget_nodes = nodes;
+}
+
+WordHunt::Progress WordHunt::progress() const { return last; }
+
+// word lengths to look for
+void WordHunt::setWordLengths(unsigned min_length, unsigned max_length) {
+    this->min_length = min_length;
+    this->max_length = max_length;
+}
+
+unsigned WordHunt::numWords() const { return num_words; }
+
+unsigned WordHunt::score() const { return total_score; }
+
+// 3 letters: 100, 4: 400, 5: 800, 6: 1400, then 400 more per letter.
+unsigned WordHunt::wordScore(unsigned length) {
+    if (length < 3) return 0;
+    if (length == 3) return 100;
+    if (length == 4) return 400;
+    if (length == 5) return 800;
+    return 1400 + 400 * (length - 6);
+}
+
+// add a found word to the results, skipping words already found.
+void WordHunt::record(const void* node, unsigned lexicons,
+                      const std::string& word_so_far, int start_coord,
+                      int mask) {
+    if (word_so_far.length() < min_length ||
+        word_so_far.length() > max_length) {
+        return;
+    }
+    // every path counts for the tiles, not only the first
+    if (gather) tally(node, word_so_far, mask);
+    if (!found_nodes.insert(node).second) return;
+    num_words++;
+    total_score += wordScore(word_so_far.length());
+    if (keep_words) {
+        this->m_vec[start_coord].push_back(word_so_far);
+        words_found[word_so_far] = lexicons;
+    }
+}
+
+// a new word adds its bigrams, and each of its paths adds the word and
+// its points to the tiles that no earlier path of it went through.
+void WordHunt::tally(const void* node, const std::string& word,
+                     unsigned mask) {
+    std::pair<std::unordered_map<const void*, unsigned>::iterator, bool> it =
+        tile_masks.emplace(node, 0u);
+    unsigned fresh = mask & ~it.first->second;
+    if (!fresh) return;
+    it.first->second |= mask;
+    stats.used_tiles |= fresh;
+    unsigned points = wordScore(word.length());
+    while (fresh) {
+        int t = __builtin_ctz(fresh);
+        fresh &= fresh - 1;
+        stats.tile_words[t]++;
+        stats.tile_points[t] += points;
+    }
+    if (!it.second) return;
+    for (unsigned i = 1; i < word.length(); i++) {
+        int a = word[i - 1] - 'a', b = word[i] - 'a';
+        if (a >= 0 && a < 26 && b >= 0 && b < 26) stats.bigrams[a][b]++;
+    }
 }
 
 // dfs method to find all the links.
-void WordHunt::dfs(const CTrie* ct, int idx, int mask, std::string word_so_far,
+template <class Node>
+void WordHunt::dfs(const Node* ct, int idx, int mask, std::string& word_so_far,
                    int start_coord) {
+    last.nodes++;
     // if it is the end of a word, then add to the vector and the set of words
     // found so far.
-    if (ct->isEndpoint() && words_set.find(word_so_far) == words_set.end()) {
-        this->m_vec[start_coord].push_back(word_so_far);
-        words_set.insert(word_so_far);
+    if (ct->isEndpoint()) {
+        record(ct, ct->lexicons(), word_so_far, start_coord, mask);
     }
 
     // the node does not have any children, then return.
     if (!ct->hasChild()) {
         return;
     }
-    int next_idx, new_row, new_col;
-    // iterate through all the positions
-    for (int x = -1; x <= 1; x++) {
-        for (int y = -1; y <= 1; y++) {
-            new_row = idx / GAME_SIZE + x;
-            new_col = idx % GAME_SIZE + y;
+    // find every child an unvisited neighbour leads to and prefetch them
+    // all before going down any, so their cache misses overlap instead of
+    // being taken one recursion at a time.
+    int next_idx[8];
+    const Node* next_ct[8];
+    int n = 0;
+    for (uint32_t todo = moves().next(idx, mask); todo; todo &= todo - 1) {
+        int t = __builtin_ctz(todo);
+        const Node* child = ct->getChild(board[t]);
+        if (!child) continue;
+        __builtin_prefetch(child);
+        next_idx[n] = t;
+        next_ct[n++] = child;
+    }
+
+    for (int k = 0; k < n; k++) {
+        // skip the branch if the tiles left can't finish any word below it.
+        take(board[next_idx[k]]);
+        if (canFinish(next_ct[k], word_so_far.length() + 1)) {
+            word_so_far.push_back(board[next_idx[k]]);
+            this->dfs(next_ct[k], next_idx[k], mask | (1 << next_idx[k]),
+                      word_so_far, start_coord);
+            word_so_far.pop_back();
+        }
+        give(board[next_idx[k]]);
+    }
+}
+
+// mark a tile with this letter as visited.
+void WordHunt::take(char letter) {
+    unsigned bit = CTrie::letterBit(letter);
+    if (--letter_counts[__builtin_ctz(bit)] == 0) avail_letters &= ~bit;
+}
+
+// mark a tile with this letter as unvisited again.
+void WordHunt::give(char letter) {
+    unsigned bit = CTrie::letterBit(letter);
+    letter_counts[__builtin_ctz(bit)]++;
+    avail_letters |= bit;
+}
+
+// a word below ct needs at least minRemaining more tiles, all of its
+// required letters, and (unless ct itself is a word) some letter of its
+// subtree to still be on the board. The longest word below must also reach
+// min_length. A node with no word below has minRemaining ~0u (0xffff in a
+// FlatTrie), so compare unsigned to prune it too.
+template <class Node>
+bool WordHunt::canFinish(const Node* ct, int depth) const {
+    if (depth > max_depth) return false;
+    if (ct->minRemaining() > (unsigned)(max_depth - depth)) return false;
+    if (depth + ct->maxRemaining() < min_length) return false;
+    if (ct->requiredLetters() & ~avail_letters) return false;
+    return ct->isEndpoint() || (ct->subtreeLetters() & avail_letters);
+}
+
+// radix dfs: from a node, every unvisited neighbour whose letter starts one
+// of the node's links begins a match of that link's label.
+void WordHunt::dfsRadix(const RTrie* rt, int idx, int mask,
+                        std::string& word_so_far, int start_coord) {
+    last.nodes++;
+    if (rt->isEndpoint()) {
+        record(rt, rt->lexicons(), word_so_far, start_coord, mask);
+    }
+
+    if (!rt->hasChild() || (int)word_so_far.length() >= max_depth) {
+        return;
+    }
+    for (uint32_t todo = moves().next(idx, mask); todo; todo &= todo - 1) {
+        int next_idx = __builtin_ctz(todo);
+        const RTrie* next_rt = rt->getChild(board[next_idx]);
+        if (next_rt) {
+            word_so_far.push_back(board[next_idx]);
+            this->matchLabel(next_rt, 1, next_idx, mask | (1 << next_idx),
+                             word_so_far, start_coord);
+            word_so_far.pop_back();
+        }
+    }
+}
 
-            // if out of bounds or in same place
-            if (new_row < 0 || new_row >= GAME_SIZE || new_col < 0 ||
-                new_col >= GAME_SIZE || !(x || y)) {
+// match label characters from pos onwards along unvisited neighbours, with
+// no trie lookups until the whole label has been placed on the board.
+void WordHunt::matchLabel(const RTrie* rt, unsigned pos, int idx, int mask,
+                          std::string& word_so_far, int start_coord) {
+    if (pos == rt->label().length()) {
+        this->dfsRadix(rt, idx, mask, word_so_far, start_coord);
+        return;
+    }
+    // the label runs past the longest word wanted
+    if ((int)word_so_far.length() >= max_depth) return;
+    char letter = rt->label()[pos];
+    for (uint32_t todo = moves().next(idx, mask); todo; todo &= todo - 1) {
+        int next_idx = __builtin_ctz(todo);
+        if (board[next_idx] == letter) {
+            word_so_far.push_back(letter);
+            this->matchLabel(rt, pos + 1, next_idx, mask | (1 << next_idx),
+                             word_so_far, start_coord);
+            word_so_far.pop_back();
+        }
+    }
+}
+
+// the dfs search as one loop over an explicit stack of frames, moving
+// between tiles with the precomputed PathAutomaton tables.
+template <class Node>
+void WordHunt::solveAutomaton(const Node* root) {
+    const PathAutomaton& pa = moves();
+    // one frame per tile on the current path
+    struct Frame {
+        const Node* node;
+        uint32_t mask;
+        uint32_t todo;  // neighbours still to try
+    } stack[GAME_SIZE * GAME_SIZE];
+    std::string word_so_far;
+
+    for (int start = 0; start < pa.tiles(); start++) {
+        const Node* ct = root->getChild(board[start]);
+        if (!ct) continue;
+        take(board[start]);
+        if (!canFinish(ct, 1)) {
+            give(board[start]);
+            continue;
+        }
+        word_so_far.assign(1, board[start]);
+        last.nodes++;
+        if (ct->isEndpoint()) {
+            record(ct, ct->lexicons(), word_so_far, start, 1u << start);
+        }
+        int depth = 0;
+        stack[0].node = ct;
+        stack[0].mask = 1u << start;
+        stack[0].todo = ct->hasChild() ? pa.next(start, stack[0].mask) : 0;
+
+        while (depth >= 0) {
+            Frame& f = stack[depth];
+            if (!f.todo) {
+                // this tile is done, step back off it
+                give(word_so_far[depth]);
+                word_so_far.pop_back();
+                depth--;
                 continue;
             }
-
-            // flatten index
-            next_idx = GAME_SIZE * new_row + new_col;
-
-            // if not already accessed and has a child with that particular
-            // letter, then recurse.
-            if (!(mask & (1 << next_idx)) &&
-                ct->hasChild(this->board[next_idx])) {
-                const CTrie* next_ct = ct->getChild(this->board[next_idx]);
-                mask |= (1 << next_idx);
-                this->dfs(next_ct, next_idx, mask,
-                          word_so_far + board[next_idx], start_coord);
+            int tile = __builtin_ctz(f.todo);
+            f.todo &= f.todo - 1;
+            const Node* next = f.node->getChild(board[tile]);
+            if (!next) continue;
+            take(board[tile]);
+            if (!canFinish(next, depth + 2)) {
+                give(board[tile]);
+                continue;
             }
+            word_so_far.push_back(board[tile]);
+            last.nodes++;
+            if (next->isEndpoint()) {
+                record(next, next->lexicons(), word_so_far, start,
+                       f.mask | (1u << tile));
+            }
+            Frame& g = stack[++depth];
+            g.node = next;
+            g.mask = f.mask | (1u << tile);
+            g.todo = next->hasChild() ? pa.next(tile, g.mask) : 0;
         }
     }
 }
 
-// solve the board, by going through all the variables.
-void WordHunt::solve() {
-    // go through all the starting tiles, if it can start with that letter, then
-    // recurse.
+// go through all the starting tiles, if it can start with that letter, then
+// recurse.
+template <class Node>
+void WordHunt::solveDfs(const Node* root) {
     for (int i = 0; i < (int)this->board.length(); i++) {
-        if (this->trie->hasChild(this->board.at(i))) {
-            const CTrie* ct = this->trie->getChild(this->board.at(i));
+        if (root->hasChild(this->board.at(i))) {
+            const Node* ct = root->getChild(this->board.at(i));
             int mask = (1 << i);
             std::string word_so_far;
             word_so_far = this->board.at(i);
-            this->dfs(ct, i, mask, word_so_far, i);
+            take(board[i]);
+            if (canFinish(ct, 1)) this->dfs(ct, i, mask, word_so_far, i);
+            give(board[i]);
+        }
+    }
+}
+
+// count a node against the budget, the clock is only read every 64 nodes.
+bool WordHunt::spend() {
+    if (out_of_budget) return false;
+    last.nodes++;
+    if (budget_nodes && last.nodes > budget_nodes) out_of_budget = true;
+    if (budget_us && (last.nodes & 63) == 0 &&
+        std::chrono::steady_clock::now() >= deadline) {
+        out_of_budget = true;
+    }
+    return !out_of_budget;
+}
+
+// dfs that tries the neighbours with the most words below them first and
+// gives up when the budget runs out.
+template <class Node>
+void WordHunt::dfsBudgeted(const Node* ct, int idx, int mask,
+                           std::string& word_so_far, int start_coord) {
+    if (!spend()) return;
+    if (ct->isEndpoint()) {
+        record(ct, ct->lexicons(), word_so_far, start_coord, mask);
+    }
+    if (!ct->hasChild()) {
+        return;
+    }
+
+    // the followable neighbours, best first (insertion sort, at most 8)
+    int next_idx[8];
+    const Node* next_ct[8];
+    int n = 0;
+    for (uint32_t todo = moves().next(idx, mask); todo; todo &= todo - 1) {
+        int t = __builtin_ctz(todo);
+        const Node* child = ct->getChild(board[t]);
+        if (!child) continue;
+        int j = n++;
+        while (j > 0 && next_ct[j - 1]->subtreeWords() < child->subtreeWords()) {
+            next_idx[j] = next_idx[j - 1];
+            next_ct[j] = next_ct[j - 1];
+            j--;
+        }
+        next_idx[j] = t;
+        next_ct[j] = child;
+    }
+
+    for (int k = 0; k < n && !out_of_budget; k++) {
+        take(board[next_idx[k]]);
+        if (canFinish(next_ct[k], word_so_far.length() + 1)) {
+            word_so_far.push_back(board[next_idx[k]]);
+            dfsBudgeted(next_ct[k], next_idx[k], mask | (1 << next_idx[k]),
+                        word_so_far, start_coord);
+            word_so_far.pop_back();
+        }
+        give(board[next_idx[k]]);
+    }
+}
+
+// search the start tiles with the most dictionary words first, until done
+// or out of budget.
+template <class Node>
+void WordHunt::solveBudgeted(const Node* root) {
+    auto begin = std::chrono::steady_clock::now();
+    deadline = begin + std::chrono::microseconds(budget_us);
+    out_of_budget = false;
+
+    std::vector<std::pair<unsigned, int> > starts;
+    double total = 0, done = 0;
+    for (int i = 0; i < (int)board.length(); i++) {
+        const Node* ct = root->getChild(board[i]);
+        if (!ct) continue;
+        starts.push_back(std::make_pair(ct->subtreeWords(), -i));
+        total += ct->subtreeWords();
+    }
+    // most words first, ties in tile order
+    std::sort(starts.rbegin(), starts.rend());
+
+    for (unsigned k = 0; k < starts.size() && !out_of_budget; k++) {
+        int i = -starts[k].second;
+        const Node* ct = root->getChild(board[i]);
+        std::string word_so_far(1, board[i]);
+        take(board[i]);
+        if (canFinish(ct, 1)) this->dfsBudgeted(ct, i, 1 << i, word_so_far, i);
+        give(board[i]);
+        if (!out_of_budget) {
+            last.tiles_done++;
+            done += starts[k].first;
         }
     }
+
+    last.complete = !out_of_budget;
+    last.coverage = total ? done / total : 1;
+    last.time_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                       std::chrono::steady_clock::now() - begin)
+                       .count();
+}
+
+// solve the board, by going through all the variables.
+void WordHunt::solve() {
+    // one atomic load, the solve keeps this version even if a reload lands
+    if (store) dict = store->current();
+    max_depth = board.length();
+    if (max_length < board.length()) max_depth = max_length;
+    last.complete = true;
+    last.nodes = 0;
+    last.time_us = 0;
+    last.tiles_done = 0;
+    last.coverage = 1;
+
+    if (budget_us || budget_nodes) {
+        for (int i = 0; i < 32; i++) letter_counts[i] = 0;
+        avail_letters = 0;
+        for (int i = 0; i < (int)this->board.length(); i++) give(board[i]);
+        // like the other engines, search a compiled in or flattened
+        // dictionary in place
+        const FlatTrie* flat = dict->flat();
+        if (flat) {
+            solveBudgeted(flat->root());
+        } else {
+            solveBudgeted(&dict->trie());
+        }
+        return;
+    }
+    last.tiles_done = board.length();
+
+    if (engine == LOCKSTEP) {
+        // a group of one, batches go through LockstepSolver directly
+        LockstepSolver(dict).solveGroup(this, 1);
+        return;
+    }
+    if (engine == RADIX_DFS) {
+        const RTrie& radix = dict->radix();
+        for (int i = 0; i < (int)this->board.length(); i++) {
+            const RTrie* rt = radix.getChild(board[i]);
+            if (rt) {
+                std::string word_so_far(1, board[i]);
+                this->matchLabel(rt, 1, i, 1 << i, word_so_far, i);
+            }
+        }
+        return;
+    }
+
+    // count the letters on the board, every tile starts unvisited.
+    for (int i = 0; i < 32; i++) letter_counts[i] = 0;
+    avail_letters = 0;
+    for (int i = 0; i < (int)this->board.length(); i++) give(board[i]);
+
+    // a dictionary compiled into the program is searched in place
+    const FlatTrie* flat = dict->flat();
+    if (engine == AUTOMATON) {
+        if (flat) {
+            solveAutomaton(flat->root());
+        } else {
+            solveAutomaton(&dict->trie());
+        }
+    } else if (flat) {
+        solveDfs(flat->root());
+    } else {
+        solveDfs(&dict->trie());
+    }
 }
 
 // priint out the results.
 void WordHunt::displayResults() {
-    std::map<int, std::vector<std::string>>::iterator it;
-    int row, col;
-    for (it = this->m_vec.begin(); it != m_vec.end(); ++it) {
-        row = it->first / GAME_SIZE;
-        col = it->first % GAME_SIZE;
-        std::cout << "( " << row << ", " << col << " ) : ";
-
-        for (std::string word : it->second) {
-            std::cout << word << " ";
-        }
-        std::cout << std::endl;
+    ResultWriter(std::cout).write(*this);
+}
+
+// lexicons a found word belongs to.
+unsigned WordHunt::lexiconsOf(const std::string& word) const {
+    std::map<std::string, unsigned>::const_iterator it = words_found.find(word);
+    if (it == words_found.end()) return 0;
+    return it->second;
+}
+
+// found words that belong to a lexicon.
+std::vector<std::string> WordHunt::wordsIn(unsigned lexicon) const {
+    std::vector<std::string> words;
+    std::map<std::string, unsigned>::const_iterator it;
+    for (it = words_found.begin(); it != words_found.end(); ++it) {
+        if (it->second & (1u << lexicon)) words.push_back(it->first);
     }
+    return words;
 }
@@ -3,38 +3,226 @@
 
 #define GAME_SIZE 4
 
-#include <set>
+#include <chrono>
+#include <map>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "CTrie.h"
+#include "Dictionary.h"
+#include "DictionaryStore.h"
+#include "RTrie.h"
 
 class WordHunt {
    public:
+    // search engines solve() can use, they find the same words.
+    enum Engine {
+        TRIE_DFS,   // one CTrie node per board tile (default)
+        RADIX_DFS,  // path-compressed RTrie, one node per edge label
+        LOCKSTEP,   // LockstepSolver, boards share one trie walk
+        AUTOMATON   // table-driven loop over PathAutomaton, no recursion
+    };
+
     WordHunt();
+    // solve against a shared dictionary, no words are copied.
+    explicit WordHunt(std::shared_ptr<const Dictionary> dict);
+    // copies share the dictionary and settings, not the board or results.
     WordHunt(const WordHunt& rhs);
+    // moves hand over everything, including the board and results.
+    WordHunt(WordHunt&& rhs) = default;
     ~WordHunt();
 
     WordHunt& operator=(const WordHunt& rhs);
+    WordHunt& operator=(WordHunt&& rhs) = default;
+
+    // load a word list into the given lexicon (0-31). Several lists can be
+    // loaded into the same trie; each word remembers which lists it came from.
+    // A dictionary only this solver holds is loaded in place; a shared one
+    // is copied first, so other solvers keep using it unchanged. Returns
+    // false, keeping the current dictionary, if the file can't be opened or
+    // the dictionary is flat (flattened or compiled in), as a FlatTrie
+    // can't take more words.
+    bool load_file(std::string filename, unsigned lexicon = 0);
 
-    void load_file(std::string filename);
+    std::shared_ptr<const Dictionary> dictionary() const;
+    void setDictionary(std::shared_ptr<const Dictionary> dict);
+
+    // take the store's current dictionary at the start of every solve, so
+    // reloads are picked up between boards. nullptr stops following.
+    void follow(std::shared_ptr<const DictionaryStore> store);
 
     void solve();
 
+    // size and shape of the loaded dictionary trie.
+    TrieShape shape() const;
+
+    // pick the search engine used by solve().
+    void setEngine(Engine e);
+    Engine getEngine() const;
+
+    // set the board to solve next, this clears the previous results.
     void setBoard(std::string& brd);
 
+    // when false, solve only counts words and points without keeping the
+    // words themselves (no per-word strings, see numWords/score).
+    void setKeepWords(bool keep);
+
+    // only find words of min_length to max_length letters. Word lists
+    // loaded afterwards drop the other words, and the search stops going
+    // deeper than max_length or down branches with no word long enough.
+    void setWordLengths(unsigned min_length, unsigned max_length);
+
+    // cap later solves at time_us microseconds and/or nodes trie nodes
+    // visited, 0 for no cap. A capped solve always runs its own DFS,
+    // whatever setEngine picked. It searches the start tiles and branches
+    // with the most words below them first (CTrie::subtreeWords, the same
+    // count Progress::coverage is measured in) and keeps whatever it found
+    // when the budget runs out. Words rather than points, because every
+    // trie node already keeps its word count, while ranking by points
+    // would need a second per-node total to weigh each word by its length.
+    // Words are credited to the start tile that reached them first in that
+    // order. Compiled in and flattened dictionaries are searched in place,
+    // as by solve().
+    void setBudget(unsigned long time_us, unsigned long nodes);
+
+    // how far the last solve got.
+    struct Progress {
+        bool complete = true;        // the whole board was searched
+        unsigned long nodes = 0;     // trie nodes visited, 0 for lockstep
+        unsigned long time_us = 0;   // time spent, capped solves only
+        unsigned tiles_done = 0;     // start tiles searched to the end
+        double coverage = 1;  // share of the start tiles' dictionary words done
+    };
+    Progress progress() const;
+
+    // per-tile statistics of a solve, for puzzle design. A word counts for
+    // every tile that some path spelling it passes through, not just the
+    // path solve() happened to find first.
+    struct Analytics {
+        unsigned tile_words[GAME_SIZE * GAME_SIZE] = {};   // words per tile
+        unsigned tile_points[GAME_SIZE * GAME_SIZE] = {};  // their points
+        unsigned used_tiles = 0;  // mask of tiles any word passes through
+        // letter pairs next to each other in the words found, each word
+        // counted once: bigrams[a][b] for "ab", a-z only.
+        unsigned bigrams[26][26] = {};
+
+        // mask of tiles that no word passes through.
+        unsigned unusedTiles() const;
+        // the n most frequent bigrams with their counts, most first.
+        std::vector<std::pair<std::string, unsigned>> topBigrams(
+            unsigned n) const;
+    };
+
+    // gather Analytics during later solves. Off by default; when off the
+    // search does no extra work. Capped solves only count the paths they
+    // got to.
+    void setAnalytics(bool enable);
+    // the statistics of the last solve, all zero unless enabled.
+    const Analytics& analytics() const;
+
+    // number of distinct words found and their total points.
+    unsigned numWords() const;
+    unsigned score() const;
+
+    // points for a word of the given length, 0 below 3 letters.
+    static unsigned wordScore(unsigned length);
+
+    // print the results as text to std::cout, see ResultWriter for other
+    // formats and streams.
     void displayResults();
 
+    // bitmask of the lexicons a found word belongs to, 0 if it wasn't found.
+    unsigned lexiconsOf(const std::string& word) const;
+
+    // all found words that belong to the given lexicon, in sorted order.
+    std::vector<std::string> wordsIn(unsigned lexicon) const;
+
    private:
-    CTrie* trie;
+    friend class LockstepSolver;
+    friend class ResultWriter;
+
+    std::shared_ptr<const Dictionary> dict;
+    std::shared_ptr<const DictionaryStore> store;
+
+    Engine engine;
 
     std::map<int, std::vector<std::string>> m_vec;
 
     std::string board;
 
-    std::set<std::string> words_set;
+    // words found so far, mapped to the lexicons they belong to.
+    std::map<std::string, unsigned> words_found;
+
+    // end nodes of the words found, used instead of words_found when the
+    // words aren't kept (an endpoint identifies its word).
+    std::unordered_set<const void*> found_nodes;
+    bool keep_words;
+    unsigned min_length, max_length;
+    // longest word the current board can hold, see setWordLengths
+    int max_depth;
+    unsigned num_words;
+    unsigned total_score;
+
+    // add a word ending at trie node `node`, spelled by the tiles in mask,
+    // to the results.
+    void record(const void* node, unsigned lexicons,
+                const std::string& word_so_far, int start_coord, int mask);
+
+    // see setAnalytics. tile_masks holds, for each word found so far, the
+    // tiles of all the paths spelling it seen so far.
+    bool gather;
+    Analytics stats;
+    std::unordered_map<const void*, unsigned> tile_masks;
+    // credit the tiles in mask not yet counted for the word ending at node.
+    void tally(const void* node, const std::string& word, unsigned mask);
 
-    void dfs(const CTrie* ct, int idx, int mask, std::string word_so_far,
+    // unvisited tiles per letter (indexed like CTrie::letterBit), and the
+    // mask of letters that still have at least one unvisited tile.
+    int letter_counts[32];
+    unsigned avail_letters;
+
+    // the trie searches work on CTrie nodes or on the FlatNodes of a
+    // dictionary compiled into the program.
+    template <class Node>
+    void solveDfs(const Node* root);
+    template <class Node>
+    void dfs(const Node* ct, int idx, int mask, std::string& word_so_far,
              int start_coord);
+
+    // radix search: dfsRadix picks the next link from a node, matchLabel
+    // walks the rest of that link's label along the board.
+    void dfsRadix(const RTrie* rt, int idx, int mask, std::string& word_so_far,
+                  int start_coord);
+    void matchLabel(const RTrie* rt, unsigned pos, int idx, int mask,
+                    std::string& word_so_far, int start_coord);
+
+    // the capped search, see setBudget.
+    unsigned long budget_us, budget_nodes;
+    Progress last;
+    std::chrono::steady_clock::time_point deadline;
+    bool out_of_budget;
+    template <class Node>
+    void solveBudgeted(const Node* root);
+    template <class Node>
+    void dfsBudgeted(const Node* ct, int idx, int mask,
+                     std::string& word_so_far, int start_coord);
+    // count a visited node, false once the budget is used up.
+    bool spend();
+
+    // the AUTOMATON engine, same words in the same order as dfs.
+    template <class Node>
+    void solveAutomaton(const Node* root);
+
+    // mark a tile visited/unvisited in the letter counts.
+    void take(char letter);
+    void give(char letter);
+
+    // whether a word can still be finished below ct with the unvisited tiles.
+    template <class Node>
+    bool canFinish(const Node* ct, int depth) const;
 };
 
 #endif
\ No newline at end of file
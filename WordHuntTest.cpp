@@ -0,0 +1,472 @@
+#include <dirent.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "BoardGen.h"
+#include "Coordinator.h"
+#include "Dictionary.h"
+#include "Lockstep.h"
+#include "ResultWriter.h"
+#include "WordDelta.h"
+#include "WordHunt.h"
+
+using std::cout;
+using std::endl;
+
+#ifndef ASSERT
+#include <csignal>  // signal handler
+#include <cstring>  // memset
+#include <string>
+char programName[128];
+
+void segFaultHandler(int, siginfo_t*, void* context) {
+  char cmdbuffer[1024];
+  char resultbuffer[128];
+  sprintf(cmdbuffer, "addr2line -Cfip -e %s %p", programName,
+      (void*)((ucontext_t*)context)->uc_mcontext.gregs[REG_RIP]);
+  std::string result = "";
+  FILE* pipe = popen(cmdbuffer, "r");
+  if (!pipe) throw std::runtime_error("popen() failed!");
+  try {
+    while (fgets(resultbuffer, sizeof resultbuffer, pipe) != NULL) {
+      result += resultbuffer;
+    }
+  } catch (...) {
+    pclose(pipe);
+    throw;
+  }
+  pclose(pipe);
+  cout << "Segmentation fault occured in " << result;
+  ((ucontext_t*)context)->uc_mcontext.gregs[REG_RIP] +=
+    2;  // skip the seg fault
+}
+
+#define ASSERT(cond) \
+do { \
+  if (!(cond)) { \
+    cout << "failed ASSERT " << #cond << " at line " << __LINE__ << endl; \
+  } else { \
+    cout << __func__ << " - (" << #cond << ")" \
+       << " passed!" << endl; \
+  } \
+} while (0)
+#endif
+
+// the engines are compared on words.txt over a fixed set of random boards
+static std::shared_ptr<const Dictionary> words() {
+  static std::shared_ptr<const Dictionary> dict =
+      Dictionary::fromFile("words.txt");
+  return dict;
+}
+
+static std::vector<std::string> boards(unsigned count) {
+  std::vector<std::string> out(1, "eaneohndlrrothts");
+  BoardGenerator gen(BoardGenerator::DICE, 7);
+  std::string board;
+  while (out.size() < count) {
+    gen.next(board);
+    out.push_back(board);
+  }
+  return out;
+}
+
+// a solve as sorted CSV rows (board, start tile, word, points, lexicons),
+// so engines that find a tile's words in a different order still match
+static std::string rows(const WordHunt& wh) {
+  std::ostringstream os;
+  {
+    ResultWriter out(os, ResultWriter::CSV);
+    out.write(wh);
+  }
+  std::istringstream is(os.str());
+  std::vector<std::string> lines;
+  std::string line;
+  while (std::getline(is, line)) lines.push_back(line);
+  std::sort(lines.begin(), lines.end());
+  std::string sorted;
+  for (unsigned i = 0; i < lines.size(); i++) sorted += lines[i] + "\n";
+  return sorted;
+}
+
+// feeds lines to a Coordinator, killing one of its workers just before
+// line kill_at is read, as if it had crashed
+class WorkerKiller : public std::streambuf {
+public:
+  WorkerKiller(const std::vector<std::string>& lines, unsigned kill_at)
+    : lines(lines), next(0), kill_at(kill_at), killed(0) {}
+
+  // pid of the worker that was killed, 0 if none was
+  pid_t victim() const { return killed; }
+
+protected:
+  int_type underflow() {
+    if (next == lines.size()) return traits_type::eof();
+    if (next++ == kill_at) killWorker();
+    line = lines[next - 1] + "\n";
+    setg(&line[0], &line[0], &line[0] + line.size());
+    return traits_type::to_int_type(line[0]);
+  }
+
+private:
+  std::vector<std::string> lines;
+  std::string line;
+  unsigned next, kill_at;
+  pid_t killed;
+
+  // the workers are this process' children, found through /proc
+  void killWorker() {
+    DIR* proc = opendir("/proc");
+    if (!proc) return;
+    while (dirent* entry = readdir(proc)) {
+      pid_t pid = atoi(entry->d_name);
+      if (pid <= 0) continue;
+      std::ifstream stat("/proc/" + std::string(entry->d_name) + "/stat");
+      std::string text;
+      std::getline(stat, text);
+      // "pid (name) state ppid ...", the name may hold spaces
+      size_t paren = text.rfind(')');
+      if (paren == std::string::npos) continue;
+      char state;
+      int ppid = 0;
+      std::istringstream(text.substr(paren + 1)) >> state >> ppid;
+      if (ppid == getpid()) {
+        kill(pid, SIGKILL);
+        killed = pid;
+        break;
+      }
+    }
+    closedir(proc);
+  }
+};
+
+struct WordHuntTest {
+  static void LockstepTest() {
+    std::vector<std::string> bs = boards(40);
+    WordHunt dfs(words());
+    // 40 boards make two full groups of lanes and a partial one
+    std::vector<WordHunt> hunts(bs.size(), WordHunt(words()));
+    for (unsigned i = 0; i < bs.size(); i++) hunts[i].setBoard(bs[i]);
+    LockstepSolver(words()).solve(hunts);
+    unsigned same = 0, found = 0;
+    for (unsigned i = 0; i < bs.size(); i++) {
+      dfs.setBoard(bs[i]);
+      dfs.solve();
+      found += dfs.numWords();
+      if (rows(dfs) == rows(hunts[i]) && dfs.score() == hunts[i].score()) {
+        same++;
+      }
+    }
+    ASSERT(found > 0);
+    ASSERT(same == bs.size());
+
+    // a single board through solve() takes a group of one
+    WordHunt one(words());
+    one.setEngine(WordHunt::LOCKSTEP);
+    one.setBoard(bs[0]);
+    one.solve();
+    dfs.setBoard(bs[0]);
+    dfs.solve();
+    ASSERT(rows(one) == rows(dfs));
+
+    // length bounds cut both engines the same way
+    unsigned all = dfs.numWords();
+    dfs.setWordLengths(4, 6);
+    one.setWordLengths(4, 6);
+    dfs.setBoard(bs[0]);
+    dfs.solve();
+    one.setBoard(bs[0]);
+    one.solve();
+    ASSERT(rows(one) == rows(dfs) && one.numWords() < all);
+  }
+
+  static void AutomatonTest() {
+    std::vector<std::string> bs = boards(40);
+    std::shared_ptr<Dictionary> flat = std::make_shared<Dictionary>(*words());
+    flat->flatten();
+    // the automaton searches CTrie and FlatTrie dictionaries alike
+    std::shared_ptr<const Dictionary> dicts[2] = {words(), flat};
+    for (int d = 0; d < 2; d++) {
+      WordHunt dfs(dicts[d]), automaton(dicts[d]);
+      automaton.setEngine(WordHunt::AUTOMATON);
+      unsigned same = 0;
+      for (unsigned i = 0; i < bs.size(); i++) {
+        dfs.setBoard(bs[i]);
+        dfs.solve();
+        automaton.setBoard(bs[i]);
+        automaton.solve();
+        // same words in the same order, over the same trie nodes
+        std::ostringstream a, b;
+        {
+          ResultWriter wa(a, ResultWriter::CSV), wb(b, ResultWriter::CSV);
+          wa.write(dfs);
+          wb.write(automaton);
+        }
+        if (a.str() == b.str() &&
+            dfs.progress().nodes == automaton.progress().nodes) {
+          same++;
+        }
+      }
+      ASSERT(same == bs.size());
+    }
+  }
+
+  static void BudgetTest() {
+    std::vector<std::string> bs = boards(10);
+    std::shared_ptr<Dictionary> flat = std::make_shared<Dictionary>(*words());
+    flat->flatten();
+    WordHunt dfs(words()), ct(words()), ft(flat);
+    // a budget never reached finds every word
+    ct.setBudget(0, ~0ul);
+    ft.setBudget(0, ~0ul);
+    unsigned same = 0;
+    for (unsigned i = 0; i < bs.size(); i++) {
+      dfs.setBoard(bs[i]);
+      dfs.solve();
+      ct.setBoard(bs[i]);
+      ct.solve();
+      ft.setBoard(bs[i]);
+      ft.solve();
+      if (ct.progress().complete && ct.wordsIn(0) == dfs.wordsIn(0) &&
+          ft.wordsIn(0) == dfs.wordsIn(0) &&
+          ft.progress().nodes == ct.progress().nodes) {
+        same++;
+      }
+    }
+    ASSERT(same == bs.size());
+
+    // a FlatTrie is searched in the same order, so it stops at the same
+    // place as the CTrie
+    dfs.setBoard(bs[0]);
+    dfs.solve();
+    ct.setBudget(0, 100);
+    ft.setBudget(0, 100);
+    ct.setBoard(bs[0]);
+    ct.solve();
+    ft.setBoard(bs[0]);
+    ft.solve();
+    ASSERT(!ct.progress().complete && ct.numWords() < dfs.numWords());
+    ASSERT(rows(ct) == rows(ft));
+    ASSERT(ct.progress().coverage == ft.progress().coverage);
+  }
+
+  static void ReloadTest() {
+    ASSERT(!Dictionary::fromFile("no-such-words.txt"));
+    WordHunt wh(words());
+    ASSERT(!wh.load_file("no-such-words.txt", 1));
+    ASSERT(wh.dictionary() == words());
+
+    // a dictionary no one else holds takes more lists in place, a shared
+    // one is copied
+    WordHunt own;
+    ASSERT(own.load_file("words.txt", 0));
+    const Dictionary* loaded = own.dictionary().get();
+    ASSERT(own.load_file("words.txt", 1) && own.dictionary().get() == loaded);
+    ASSERT(own.dictionary()->lexicons() == 3u);
+    std::shared_ptr<const Dictionary> held = own.dictionary();
+    ASSERT(own.load_file("words.txt", 2) && own.dictionary() != held);
+    ASSERT(held->lexicons() == 3u && own.dictionary()->lexicons() == 7u);
+    // a flat one can't take more words
+    std::shared_ptr<Dictionary> flat = std::make_shared<Dictionary>(*words());
+    flat->flatten();
+    own.setDictionary(flat);
+    ASSERT(!own.load_file("words.txt", 3) && own.dictionary() == flat);
+
+    // a reload that can't read its word list keeps the current version
+    DictionaryStore store(words());
+    std::vector<std::string> lists(1, "no-such-words.txt");
+    DictionaryStore::Report r = store.reload(store.fromFiles(lists));
+    unsigned long version;
+    ASSERT(!r.published && r.version == 1);
+    ASSERT(store.current(&version) == words() && version == 1);
+    lists[0] = "words.txt";
+    r = store.reload(store.fromFiles(lists));
+    ASSERT(r.published && r.version == 2 && r.words == words()->trie().subtreeWords());
+  }
+
+  static void DeltaTest() {
+    std::vector<std::string> bs = boards(10);
+    WordHunt dfs(words());
+    dfs.setBoard(bs[0]);
+    dfs.solve();
+    std::vector<std::string> found = dfs.wordsIn(0);
+    // drop every other word found, add the prefixes of the rest, all of
+    // them paths on the board
+    WordDelta delta;
+    for (unsigned i = 0; i < found.size(); i++) {
+      if (i % 2) {
+        delta.remove(found[i]);
+      } else if (found[i].length() > 3) {
+        delta.add(found[i].substr(0, found[i].length() - 1));
+      }
+    }
+
+    // the radix copy is patched, not rebuilt, so it has to match one built
+    // after the delta
+    std::shared_ptr<Dictionary> patched = std::make_shared<Dictionary>(*words());
+    patched->radix();
+    std::shared_ptr<Dictionary> fresh = std::make_shared<Dictionary>(*words());
+    ASSERT(patched->applyDelta(delta) == fresh->applyDelta(delta));
+    ASSERT(patched->radix().numNodes() == fresh->radix().numNodes());
+    WordHunt radix(patched), after(fresh);
+    radix.setEngine(WordHunt::RADIX_DFS);
+    unsigned same = 0;
+    for (unsigned i = 0; i < bs.size(); i++) {
+      radix.setBoard(bs[i]);
+      radix.solve();
+      after.setBoard(bs[i]);
+      after.solve();
+      if (rows(radix) == rows(after)) same++;
+    }
+    ASSERT(same == bs.size());
+    after.setBoard(bs[0]);
+    after.solve();
+    ASSERT(after.numWords() != dfs.numWords());
+  }
+
+  static void CoordinatorTest() {
+    std::vector<std::string> bs = boards(60);
+    WordHunt wh(words());
+    std::ostringstream single;
+    {
+      ResultWriter out(single, ResultWriter::JSONL);
+      for (unsigned i = 0; i < bs.size(); i++) {
+        wh.setBoard(bs[i]);
+        wh.solve();
+        out.write(wh);
+      }
+    }
+
+    // few boards in flight per worker, so results arrive out of order and
+    // have to wait for the ones before them
+    Coordinator::Options opts;
+    opts.workers = 3;
+    opts.in_flight = 2;
+    opts.format = ResultWriter::JSONL;
+    for (unsigned workers = 1; workers <= 3; workers += 2) {
+      opts.workers = workers;
+      std::string text;
+      for (unsigned i = 0; i < bs.size(); i++) text += bs[i] + "\n";
+      std::istringstream in(text);
+      std::ostringstream out;
+      Coordinator::Stats stats;
+      {
+        Coordinator coordinator(wh, DictionaryStore::Builder(), opts);
+        stats = coordinator.run(in, out);
+      }
+      ASSERT(out.str() == single.str());
+      ASSERT(stats.boards == bs.size() && stats.failed == 0 && stats.respawns == 0);
+    }
+
+    // a worker killed mid-run is replaced and its boards handed out again
+    WorkerKiller killer(bs, 30);
+    std::istream in(&killer);
+    std::ostringstream out;
+    Coordinator::Stats stats;
+    {
+      Coordinator coordinator(wh, DictionaryStore::Builder(), opts);
+      stats = coordinator.run(in, out);
+    }
+    ASSERT(killer.victim() != 0 && stats.respawns >= 1);
+    ASSERT(out.str() == single.str() && stats.boards == bs.size());
+  }
+
+  static void AnalyticsTest() {
+    // c a t z
+    // a z z z
+    // z z z z
+    // z z z z
+    std::string board = "catzazzzzzzzzzzz";
+    WordDelta delta;
+    const char* list[] = {"cat", "tac", "aca", "caat", "zaz", "act", "dog"};
+    for (const char* w : list) delta.add(w);
+    std::shared_ptr<Dictionary> dict = std::make_shared<Dictionary>();
+    dict->applyDelta(delta);
+
+    WordHunt::Engine engines[] = {WordHunt::TRIE_DFS, WordHunt::RADIX_DFS,
+                                  WordHunt::LOCKSTEP, WordHunt::AUTOMATON};
+    for (WordHunt::Engine e : engines) {
+      WordHunt wh(dict);
+      wh.setEngine(e);
+      wh.setBoard(board);
+      wh.solve();
+      // off by default
+      ASSERT(wh.analytics().used_tiles == 0 && wh.analytics().tile_words[0] == 0);
+
+      wh.setAnalytics(true);
+      wh.setBoard(board);
+      wh.solve();
+      const WordHunt::Analytics& a = wh.analytics();
+      ASSERT(wh.numWords() == 5 && wh.score() == 800);
+      // cat, tac, aca and caat go through tiles 0, 1 and 2 or 4; aca has
+      // two paths over the same tiles. zaz goes around either 'a', so all
+      // the z's next to one count.
+      unsigned words[16] = {4, 5, 3, 0, 3, 1, 1, 0, 1, 1, 0, 0, 0, 0, 0, 0};
+      unsigned points[16] = {700, 800, 600, 0, 600, 100, 100, 0, 100, 100};
+      bool same = true;
+      for (int t = 0; t < 16; t++) {
+        same = same && a.tile_words[t] == words[t] && a.tile_points[t] == points[t];
+      }
+      ASSERT(same);
+      ASSERT(a.unusedTiles() == 0xfc88);
+
+      // ca in cat, aca and caat; each word counts once however many paths
+      ASSERT(a.bigrams['c' - 'a']['a' - 'a'] == 3 && a.bigrams['z' - 'a']['a' - 'a'] == 1);
+      std::vector<std::pair<std::string, unsigned>> top = a.topBigrams(3);
+      ASSERT(top.size() == 3 && top[0].first == "ca" && top[0].second == 3);
+      ASSERT(top[1].first == "ac" && top[1].second == 2 && top[2].first == "at");
+      ASSERT(a.topBigrams(10).size() == 7 && a.topBigrams(10)[6].first == "za");
+
+      // a new board starts from zero
+      std::string empty = "zzzzzzzzzzzzzzzz";
+      wh.setBoard(empty);
+      wh.solve();
+      ASSERT(wh.numWords() == 0 && wh.analytics().unusedTiles() == 0xffff);
+    }
+  }
+
+  static void CsvTest() {
+    WordHunt wh(words());
+    std::string board = "ab,\"tarestonelip";
+    wh.setBoard(board);
+    wh.solve();
+    std::ostringstream os;
+    {
+      ResultWriter out(os, ResultWriter::CSV);
+      out.write(wh);
+    }
+    std::istringstream is(os.str());
+    std::string header, row;
+    std::getline(is, header);
+    std::getline(is, row);
+    ASSERT(header == "board,row,col,word,length,points,lexicons");
+    // the comma and quote stay inside one quoted field
+    ASSERT(row.find("\"ab,\"\"tarestonelip\",") == 0);
+    ASSERT(std::count(row.begin(), row.end(), ',') == 7);
+  }
+};
+
+int main(int, char* argv[]) {
+  cout << "Testing WordHunt" << endl;
+  // register a seg fault hanlder
+  sprintf(programName, "%s", argv[0]);
+  struct sigaction signalAction;
+  memset(&signalAction, 0, sizeof(struct sigaction));
+  signalAction.sa_flags = SA_SIGINFO;
+  signalAction.sa_sigaction = segFaultHandler;
+  sigaction(SIGSEGV, &signalAction, NULL);
+
+  WordHuntTest::LockstepTest();
+  WordHuntTest::AutomatonTest();
+  WordHuntTest::BudgetTest();
+  WordHuntTest::ReloadTest();
+  WordHuntTest::DeltaTest();
+  WordHuntTest::CoordinatorTest();
+  WordHuntTest::AnalyticsTest();
+  WordHuntTest::CsvTest();
+}
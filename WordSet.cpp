@@ -0,0 +1,86 @@
+#include <cstring>
+
+#include "WordSet.h"
+
+//default constructor, an empty table of 16 slots
+WordSet::WordSet(): slots(16), empty(0) {
+}
+
+//add a word, growing the table to keep it at most half full
+void WordSet::insert(const std::string& word, unsigned lexicons) {
+    uint64_t h = hash(word.data(), word.length());
+    unsigned long i = find(word.data(), word.length(), h);
+    if (slots[i].entry) {
+        Entry &e = entries[slots[i].entry - 1];
+        if (!e.lexicons && lexicons) empty--;
+        e.lexicons |= lexicons;
+        return;
+    }
+    if (!lexicons) empty++;
+    Entry e = {(uint32_t)pool.size(), (uint32_t)word.length(), lexicons};
+    pool += word;
+    entries.push_back(e);
+    slots[i].hash = (uint32_t)h;
+    slots[i].entry = entries.size();
+    if (entries.size() * 2 > slots.size()) grow();
+}
+
+//clear the word's lexicons, the entry stays where it is
+bool WordSet::remove(const std::string& word, unsigned lexicons) {
+    unsigned long i = find(word.data(), word.length(), hash(word.data(), word.length()));
+    if (!slots[i].entry) return false;
+    Entry &e = entries[slots[i].entry - 1];
+    if (!(e.lexicons & lexicons)) return false;
+    e.lexicons &= ~lexicons;
+    if (!e.lexicons) empty++;
+    return true;
+}
+
+//find the lexicons a word belongs to
+unsigned WordSet::lookup(const char* word, unsigned long length) const {
+    unsigned long i = find(word, length, hash(word, length));
+    if (!slots[i].entry) return 0;
+    return entries[slots[i].entry - 1].lexicons;
+}
+
+//size of the table, entries and pooled letters
+unsigned long WordSet::bytes() const {
+    return slots.capacity() * sizeof(Slot) + entries.capacity() * sizeof(Entry) + pool.capacity();
+}
+
+//FNV-1a, mixed at the end so the low bits pick slots well
+uint64_t WordSet::hash(const char* word, unsigned long length) {
+    uint64_t h = 14695981039346656037ull;
+    for (unsigned long i = 0; i < length; i++) {
+        h = (h ^ (unsigned char)word[i]) * 1099511628211ull;
+    }
+    h ^= h >> 29;
+    h *= 0xbf58476d1ce4e5b9ull;
+    return h ^ (h >> 32);
+}
+
+//linear probing from the word's home slot
+unsigned long WordSet::find(const char* word, unsigned long length, uint64_t h) const {
+    unsigned long mask = slots.size() - 1;
+    for (unsigned long i = h & mask;; i = (i + 1) & mask) {
+        const Slot &s = slots[i];
+        if (!s.entry) return i;
+        if (s.hash != (uint32_t)h) continue;
+        const Entry &e = entries[s.entry - 1];
+        if (e.length == length && memcmp(pool.data() + e.offset, word, length) == 0) return i;
+    }
+}
+
+//double the table and put every slot back, the stored hashes still hold
+//all the bits a table this size uses
+void WordSet::grow() {
+    std::vector<Slot> old(slots.size() * 2);
+    old.swap(slots);
+    unsigned long mask = slots.size() - 1;
+    for (unsigned long j = 0; j < old.size(); j++) {
+        if (!old[j].entry) continue;
+        unsigned long i = old[j].hash & mask;
+        while (slots[i].entry) i = (i + 1) & mask;
+        slots[i] = old[j];
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef WORDSET_H
+#define WORDSET_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+ * An exact membership index: a hash set of words, each mapped to the
+ * lexicons it belongs to. The letters of all words share one pool and the
+ * table is open addressed, so a lookup is one hash of the word and usually
+ * a single probe and compare, with no allocation.
+ */
+class WordSet {
+public:
+  /**
+   * Default Constructor.
+   */
+  WordSet();
+
+  /**
+   * Add a word as a member of the given lexicons, keeping any lexicons it
+   * is already in.
+   * \param word the word to add
+   * \param lexicons bitmask of lexicons
+   */
+  void insert(const std::string &word, unsigned lexicons);
+
+  /**
+   * Remove a word from the given lexicons. Its slot is kept, so a word in
+   * no lexicon any more still takes space until the set is rebuilt.
+   * \param word the word to remove
+   * \param lexicons bitmask of lexicons
+   * \return true if the word was in any of those lexicons
+   */
+  bool remove(const std::string &word, unsigned lexicons);
+
+  /**
+   * Find the lexicons a given word belongs to.
+   * \param word the first letter of the word
+   * \param length the number of letters
+   * \return bitmask of lexicons containing the word, 0 if it is not a member
+   */
+  unsigned lookup(const char *word, unsigned long length) const;
+  unsigned lookup(const std::string &word) const {
+    return lookup(word.data(), word.length());
+  }
+
+  /**
+   * \param word the word to check
+   * \return true if word is a member of any lexicon
+   */
+  bool contains(const std::string &word) const { return lookup(word) != 0; }
+
+  /**
+   * \return the number of distinct words in any lexicon
+   */
+  unsigned long size() const { return entries.size() - empty; }
+
+  /**
+   * \return bytes taken by the table, entries and letters
+   */
+  unsigned long bytes() const;
+
+private:
+  struct Entry {
+    uint32_t offset;
+    uint32_t length;
+    uint32_t lexicons;
+  };
+  struct Slot {
+    /** the word's hash, to skip most compares */
+    uint32_t hash;
+    /** index into entries plus one, 0 for an empty slot */
+    uint32_t entry;
+  };
+
+  std::vector<Slot> slots;
+  std::vector<Entry> entries;
+  std::string pool;
+  /** entries in no lexicon, left behind by remove */
+  unsigned long empty;
+
+  static uint64_t hash(const char *word, unsigned long length);
+  /** the slot holding word, or the empty slot it would go in */
+  unsigned long find(const char *word, unsigned long length, uint64_t h) const;
+  void grow();
+};
+
+#endif
@@ -0,0 +1,35 @@
+#include <iostream>
+#include <string>
+
+#include "Dictionary.h"
+#include "FlatTrie.h"
+
+// writes C++ source holding a pre-built FlatTrie of the given word lists,
+// each list in its own lexicon:
+//   dictGen [--name=embeddedDictionary] words.txt [more.txt ...] > out.cpp
+int main(int argc, char* argv[]) {
+    std::string name = "embeddedDictionary";
+    Dictionary dict;
+    unsigned lexicon = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 7, "--name=") == 0) {
+            name = arg.substr(7);
+        } else if (lexicon < 32) {
+            if (!dict.load_file(arg, lexicon++)) {
+                std::cerr << "dictGen: can't read " << arg << std::endl;
+                return 1;
+            }
+        }
+    }
+    if (lexicon == 0) {
+        std::cerr << "usage: dictGen [--name=NAME] words.txt ..." << std::endl;
+        return 1;
+    }
+
+    FlatTrie flat(dict.trie(), dict.lexicons());
+    flat.writeSource(std::cout, name);
+    std::cerr << "dictGen: " << flat.numNodes() << " nodes, "
+              << flat.numNodes() * sizeof(FlatNode) << " bytes" << std::endl;
+    return 0;
+}
@@ -0,0 +1,40 @@
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "WordDelta.h"
+
+// writes the delta (see WordDelta) that turns one word list into another,
+// for wordHunt --delta or Dictionary::applyDelta:
+//   wordDiff [--lexicon=N] old.txt new.txt > delta.txt
+int main(int argc, char* argv[]) {
+    unsigned lexicon = 0;
+    std::string files[2];
+    int given = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 10, "--lexicon=") == 0) {
+            lexicon = std::strtoul(arg.c_str() + 10, nullptr, 10);
+        } else if (given < 2) {
+            files[given++] = arg;
+        }
+    }
+    if (given < 2 || lexicon > 31) {
+        std::cerr << "usage: wordDiff [--lexicon=N] old.txt new.txt"
+                  << std::endl;
+        return 1;
+    }
+    std::ifstream before(files[0]), after(files[1]);
+    if (!before || !after) {
+        std::cerr << "wordDiff: can't read " << (before ? files[1] : files[0])
+                  << std::endl;
+        return 1;
+    }
+
+    WordDelta delta = WordDelta::diff(before, after, lexicon);
+    delta.write(std::cout);
+    std::cerr << "wordDiff: " << delta.removals().size() << " removed, "
+              << delta.additions().size() << " added" << std::endl;
+    return 0;
+}
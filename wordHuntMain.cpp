@@ -1,37 +1,438 @@
+#include <atomic>
 #include <chrono>
+#include <csignal>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <vector>
 
+#include "Anagrams.h"
+#include "BoardStats.h"
 #include "CTrie.h"
+#include "Coordinator.h"
+#ifdef EMBEDDED_DICT
+#include "EmbeddedDict.h"
+#endif
+#include "PerfCounters.h"
+#include "ResultWriter.h"
 #include "WordHunt.h"
 
 using std::cout;
 using std::endl;
 using namespace std::chrono;
 
-int main() {
+// set by SIGHUP, batch mode reloads the word lists between boards
+static std::atomic<bool> reload_requested(false);
+
+static void requestReload(int) { reload_requested = true; }
+
+// value of a "--name=value" argument, or nullptr if arg isn't that option.
+static const char* option(const std::string& arg, const std::string& name) {
+    if (arg.compare(0, name.length() + 3, "--" + name + "=") != 0) {
+        return nullptr;
+    }
+    return arg.c_str() + name.length() + 3;
+}
+
+int main(int argc, char* argv[]) {
     WordHunt wh;
+    // board statistics mode settings, see --stats
+    unsigned long stat_boards = 0;
+    std::string dist = "dice";
+    unsigned threads = 0, top_n = 10, seed = 1;
+    // result output settings, see --format and --batch
+    ResultWriter::Format format = ResultWriter::TEXT;
+    bool batch = false;
+    // multi-process batch settings, see --workers
+    unsigned workers = 0;
+    bool pin = false;
+    unsigned min_length = 0, max_length = ~0u;
+    unsigned long deadline_us = 0, node_budget = 0;
+    std::vector<std::string> word_lists;
+    // autocomplete settings, see --complete
+    const char* complete_prefix = nullptr;
+    std::string counts_file;
+    // hardware counters around loading and solving, see --counters
+    bool counters = false;
+    // search a flattened copy of the words, see --layout
+    bool flatten = false, huge_pages = false;
+    unsigned bfs_levels = FlatTrie::BFS_LEVELS;
+    // changes to the word lists applied after loading, see --delta
+    std::string delta_file;
+    // anagrams mode settings, see --anagrams
+    bool anagrams = false;
+    std::string rack;
+
     auto start = high_resolution_clock::now();
-    // hard coded file
-    wh.load_file("words.txt");
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        const char* value;
+        if (arg == "--engine=radix") {
+            wh.setEngine(WordHunt::RADIX_DFS);
+        } else if (arg == "--engine=lockstep") {
+            wh.setEngine(WordHunt::LOCKSTEP);
+        } else if (arg == "--engine=automaton") {
+            wh.setEngine(WordHunt::AUTOMATON);
+        } else if (arg == "--engine=dfs") {
+            wh.setEngine(WordHunt::TRIE_DFS);
+        } else if ((value = option(arg, "stats"))) {
+            stat_boards = std::strtoul(value, nullptr, 10);
+        } else if ((value = option(arg, "dist"))) {
+            dist = value;
+        } else if ((value = option(arg, "threads"))) {
+            threads = std::strtoul(value, nullptr, 10);
+        } else if ((value = option(arg, "top"))) {
+            top_n = std::strtoul(value, nullptr, 10);
+        } else if ((value = option(arg, "seed"))) {
+            seed = std::strtoul(value, nullptr, 10);
+        } else if ((value = option(arg, "format"))) {
+            if (!ResultWriter::fromName(value, format)) {
+                std::cerr << "unknown format " << value << endl;
+                return 1;
+            }
+        } else if (arg == "--batch") {
+            batch = true;
+        } else if ((value = option(arg, "workers"))) {
+            workers = std::strtoul(value, nullptr, 10);
+        } else if (arg == "--pin") {
+            pin = true;
+        } else if ((value = option(arg, "deadline-us"))) {
+            deadline_us = std::strtoul(value, nullptr, 10);
+        } else if ((value = option(arg, "node-budget"))) {
+            node_budget = std::strtoul(value, nullptr, 10);
+        } else if ((value = option(arg, "min-length"))) {
+            min_length = std::strtoul(value, nullptr, 10);
+        } else if ((value = option(arg, "max-length"))) {
+            max_length = std::strtoul(value, nullptr, 10);
+        } else if (arg == "--layout=bfs") {
+            flatten = true;
+            bfs_levels = ~0u;
+        } else if (arg == "--layout=hybrid") {
+            flatten = true;
+        } else if ((value = option(arg, "layout")) &&
+                   std::string(value).compare(0, 7, "hybrid:") == 0) {
+            flatten = true;
+            bfs_levels = std::strtoul(value + 7, nullptr, 10);
+        } else if (arg == "--huge-pages") {
+            huge_pages = true;
+        } else if (arg == "--analytics") {
+            wh.setAnalytics(true);
+        } else if (arg == "--counters") {
+            counters = true;
+        } else if ((value = option(arg, "complete"))) {
+            complete_prefix = value;
+        } else if ((value = option(arg, "delta"))) {
+            delta_file = value;
+        } else if (arg == "--anagrams") {
+            anagrams = true;
+        } else if ((value = option(arg, "anagrams"))) {
+            anagrams = true;
+            rack = value;
+        } else if ((value = option(arg, "counts"))) {
+            counts_file = value;
+        } else if (word_lists.size() < 32) {
+            word_lists.push_back(arg);
+        } else {
+            std::cerr << "at most 32 word lists (lexicons) are supported"
+                      << endl;
+            return 1;
+        }
+    }
+    wh.setWordLengths(min_length, max_length);
+    // a capped solve has its own search order, see WordHunt::setBudget
+    if ((deadline_us || node_budget) && wh.getEngine() != WordHunt::TRIE_DFS) {
+        std::cerr << "--deadline-us and --node-budget only work with "
+                     "--engine=dfs" << endl;
+        return 1;
+    }
+    wh.setBudget(deadline_us, node_budget);
+    std::unique_ptr<PerfCounters> perf;
+    if (counters) perf.reset(new PerfCounters);
+    // each word list given on the command line becomes its own lexicon,
+    // otherwise fall back to the compiled in words or the hard coded file
+    WordDelta delta;
+    if (!delta_file.empty()) {
+        std::ifstream file(delta_file);
+        if (!file) {
+            std::cerr << "can't read " << delta_file << endl;
+            return 1;
+        }
+        unsigned long malformed;
+        delta = WordDelta::read(file, &malformed);
+        if (malformed) {
+            std::cerr << delta_file << ": skipped " << malformed
+                      << " malformed lines" << endl;
+        }
+    }
+    unsigned long delta_changed = 0;
+#ifdef EMBEDDED_DICT
+    if (word_lists.empty()) {
+        wh.setDictionary(Dictionary::fromFlat(embeddedDictionary()));
+        // the compiled in nodes can't change, patch a CTrie copy instead
+        if (delta.size()) {
+            std::shared_ptr<Dictionary> dict =
+                std::make_shared<Dictionary>(*wh.dictionary());
+            delta_changed = dict->applyDelta(delta);
+            if (flatten) dict->flatten(bfs_levels, huge_pages);
+            wh.setDictionary(dict);
+        }
+    }
+#else
+    if (word_lists.empty()) word_lists.push_back("words.txt");
+#endif
+    if (!word_lists.empty()) {
+        std::shared_ptr<Dictionary> dict = std::make_shared<Dictionary>();
+        dict->setWordLengths(min_length, max_length);
+        for (unsigned i = 0; i < word_lists.size(); i++) {
+            if (!dict->load_file(word_lists[i], i)) {
+                std::cerr << "can't read " << word_lists[i] << endl;
+                return 1;
+            }
+        }
+        delta_changed = dict->applyDelta(delta);
+        if (flatten) dict->flatten(bfs_levels, huge_pages);
+        wh.setDictionary(dict);
+    }
+    PerfCounters::Sample load_counts;
+    if (perf) load_counts = perf->end();
+    auto loaded = high_resolution_clock::now();
+    // keep stdout clean for the machine readable formats
+    std::ostream& info = format == ResultWriter::TEXT ? cout : std::cerr;
+    info << "Dictionary trie:\n" << wh.shape();
+    if (delta.size()) {
+        info << "Delta " << delta_file << ": " << delta_changed << " of "
+             << delta.size() << " changes applied\n";
+    }
+    if (perf) {
+        if (!perf->error().empty()) {
+            info << "Some counters unavailable (" << perf->error() << ")\n";
+        }
+        PerfCounters::print(info, "load", load_counts, 0);
+    }
+    // the shape walks every trie node, time neither it nor the other load
+    // reports as loading or solving
     auto mid = high_resolution_clock::now();
+    auto reporting = mid - loaded;
+
+    // print the most frequent dictionary words starting with a prefix
+    if (complete_prefix) {
+        std::vector<std::pair<std::string, unsigned long> > counts;
+        if (!counts_file.empty()) {
+            std::ifstream file(counts_file);
+            if (!file) {
+                std::cerr << "can't read " << counts_file << endl;
+                return 1;
+            }
+            counts = Completer::readCounts(file);
+        }
+        std::unique_ptr<Completer> c =
+            wh.dictionary()->buildCompleter(counts, top_n);
+        auto built = high_resolution_clock::now();
+        std::vector<std::string> words = c->complete(complete_prefix, top_n);
+        auto stop = high_resolution_clock::now();
+        for (unsigned i = 0; i < words.size(); i++) {
+            cout << words[i] << " " << c->count(words[i]) << "\n";
+        }
+        cout << "Completion index: " << c->bytes() << " bytes, "
+             << c->cacheBytes() << " of them for the top " << c->topK()
+             << " lists, built in "
+             << duration_cast<microseconds>(built - mid).count() / 1e6
+             << " seconds, answered in "
+             << duration_cast<nanoseconds>(stop - built).count() << " ns"
+             << endl;
+        return 0;
+    }
+
+    // words made from a rack of letters instead of a board: one rack given
+    // on the command line, or with --batch one per line of stdin, solved
+    // on --threads threads a chunk at a time. Each rack's line lists its
+    // word count, score and words, best first.
+    if (anagrams) {
+        Anagrams solver(wh.dictionary());
+        solver.setWordLengths(min_length, max_length);
+        if (!batch) {
+            Anagrams::Result r = solver.solve(rack);
+            auto stop = high_resolution_clock::now();
+            for (unsigned i = 0; i < r.words.size(); i++) {
+                cout << r.words[i] << " "
+                     << WordHunt::wordScore(r.words[i].length()) << "\n";
+            }
+            cout << r.words.size() << " words for " << r.score
+                 << " points, " << r.nodes << " nodes in "
+                 << duration_cast<microseconds>(stop - mid).count() / 1e6
+                 << " seconds" << endl;
+            return 0;
+        }
+        std::ios::sync_with_stdio(false);
+        unsigned long solved = 0;
+        std::vector<std::string> racks;
+        std::string line;
+        bool more = true;
+        while (more) {
+            racks.clear();
+            while (racks.size() < 4096 &&
+                   (more = (bool)std::getline(std::cin, line))) {
+                racks.push_back(line);
+            }
+            std::vector<Anagrams::Result> results =
+                solver.solveAll(racks, threads);
+            for (unsigned i = 0; i < results.size(); i++) {
+                cout << results[i].rack << " " << results[i].words.size()
+                     << " " << results[i].score << ":";
+                for (unsigned w = 0; w < results[i].words.size(); w++) {
+                    cout << " " << results[i].words[w];
+                }
+                cout << "\n";
+            }
+            solved += racks.size();
+        }
+        cout.flush();
+        auto stop = high_resolution_clock::now();
+        double secs = duration_cast<microseconds>(stop - mid).count() / 1e6;
+        std::cerr << "Time taken to solve racks: " << secs << " seconds ("
+                  << solved / secs << " racks/second)" << endl;
+        return 0;
+    }
+
+    // generate and solve many random boards, printing only aggregates
+    if (stat_boards) {
+        BoardStats stats =
+            runBoardStats(wh, dist, stat_boards, threads, top_n, seed);
+        auto stop = high_resolution_clock::now();
+        stats.print(cout);
+        double secs = duration_cast<microseconds>(stop - mid).count() / 1e6;
+        cout << "Time taken to solve boards: " << secs << " seconds ("
+             << stat_boards / secs << " boards/second)" << endl;
+        return 0;
+    }
+
+    ResultWriter out(cout, format);
+
+    // shard the boards read from stdin over worker processes
+    if (batch && workers) {
+        Coordinator::Options opts;
+        opts.workers = workers;
+        opts.pin = pin;
+        opts.format = format;
+        // pinned workers load their own copy of the word lists on their node
+        DictionaryStore::Builder build;
+        if (pin && !word_lists.empty()) {
+            build = DictionaryStore::fromFiles(word_lists, *wh.dictionary());
+        }
+        Coordinator::Stats stats;
+        {
+            Coordinator coordinator(wh, build, opts);
+            stats = coordinator.run(std::cin, cout);
+        }
+        std::cerr << "Solved " << stats.boards << " boards (" << stats.failed
+                  << " failed, " << stats.respawns << " workers restarted) in "
+                  << stats.secs << " seconds (" << stats.boards / stats.secs
+                  << " boards/second)\nPer worker:";
+        for (unsigned i = 0; i < stats.per_worker.size(); i++) {
+            std::cerr << " " << stats.per_worker[i];
+        }
+        std::cerr << endl;
+        return 0;
+    }
+
+    // solve every board read from stdin, one per line. SIGHUP rebuilds the
+    // dictionary from the word lists (or the compiled in words) in the
+    // background and swaps it in; a reload that fails keeps the old one.
+    if (batch) {
+        std::ios::sync_with_stdio(false);
+        std::shared_ptr<DictionaryStore> store =
+            std::make_shared<DictionaryStore>(wh.dictionary());
+        wh.follow(store);
+        DictionaryStore::Builder rebuild = store->fromFiles(word_lists);
+#ifdef EMBEDDED_DICT
+        if (word_lists.empty()) {
+            rebuild = []() {
+                return Dictionary::fromFlat(embeddedDictionary());
+            };
+        }
+#endif
+        std::signal(SIGHUP, requestReload);
+        unsigned long solved = 0, nodes = 0;
+        PerfCounters::Sample solve_counts, write_counts;
+        std::string board;
+        while (std::getline(std::cin, board)) {
+            if (reload_requested.exchange(false)) {
+                store->reloadAsync(rebuild, [](const DictionaryStore::Report& r) {
+                    if (!r.published) {
+                        std::cerr << "Dictionary reload failed, a word list "
+                                     "can't be read; keeping version "
+                                  << r.version << "\n";
+                        return;
+                    }
+                    std::cerr << "Dictionary version " << r.version << ": "
+                              << r.words << " words in " << r.build_ms
+                              << " ms\n";
+                });
+            }
+            if (board.length() != GAME_SIZE * GAME_SIZE) {
+                if (!board.empty()) std::cerr << "skipping " << board << endl;
+                continue;
+            }
+            wh.setBoard(board);
+            if (perf) perf->start();
+            wh.solve();
+            if (perf) {
+                solve_counts += perf->end();
+                nodes += wh.progress().nodes;
+                perf->start();
+            }
+            out.write(wh);
+            if (perf) write_counts += perf->end();
+            solved++;
+        }
+        if (perf) perf->start();
+        out.flush();
+        if (perf) {
+            write_counts += perf->end();
+            PerfCounters::print(std::cerr, "solve", solve_counts, nodes);
+            PerfCounters::print(std::cerr, "write", write_counts, 0);
+        }
+        auto stop = high_resolution_clock::now();
+        double secs = duration_cast<microseconds>(stop - mid).count() / 1e6;
+        std::cerr << "Time taken to solve boards: " << secs << " seconds ("
+                  << solved / secs << " boards/second)" << endl;
+        return 0;
+    }
+
     std::string board = "eaneohndlrrothts";
     wh.setBoard(board);
 
+    if (perf) perf->start();
     wh.solve();
+    PerfCounters::Sample solve_counts;
+    if (perf) solve_counts = perf->end();
     auto stop = high_resolution_clock::now();
-    wh.displayResults();
+    out.write(wh);
+    out.flush();
+    if (perf) {
+        PerfCounters::print(info, "solve", solve_counts, wh.progress().nodes);
+    }
+
+    if (deadline_us || node_budget) {
+        WordHunt::Progress p = wh.progress();
+        info << "Search " << (p.complete ? "complete" : "stopped early")
+             << ": " << p.nodes << " nodes in " << p.time_us << " us, "
+             << p.tiles_done << " start tiles done, coverage "
+             << p.coverage * 100 << "%, " << wh.numWords() << " words for "
+             << wh.score() << " points" << endl;
+    }
 
-    auto total = duration_cast<microseconds>(stop - start);
-    auto trie_formation = duration_cast<microseconds>(mid - start);
+    auto total = duration_cast<microseconds>(stop - start - reporting);
+    auto trie_formation = duration_cast<microseconds>(loaded - start);
     auto search = duration_cast<microseconds>(stop - mid);
 
-    cout << "Total Time: " << total.count() / 1e6 << " seconds" << endl;
+    info << "Total Time: " << total.count() / 1e6 << " seconds" << endl;
 
-    cout << "Time taken to form Trie: " << trie_formation.count() / 1e6
+    info << "Time taken to form Trie: " << trie_formation.count() / 1e6
          << " seconds" << endl;
 
-    cout << "Time taken to search Board: " << search.count() / 1e6 << " seconds"
+    info << "Time taken to search Board: " << search.count() / 1e6 << " seconds"
          << endl;
 
     return 0;